@@ -25,21 +25,21 @@
 // _s for gt::gslice
 using namespace gt::placeholders;
 
-static const gt::gtensor<double, 1> stencil3 = {-0.5, 0.0, 0.5};
-static const gt::gtensor<double, 1> stencil5 = {1.0 / 12.0, -2.0 / 3.0, 0.0,
+static const gt::stensor<double, 3> stencil3 = {-0.5, 0.0, 0.5};
+static const gt::stensor<double, 5> stencil5 = {1.0 / 12.0, -2.0 / 3.0, 0.0,
                                                 2.0 / 3.0, -1.0 / 12.0};
-static const gt::gtensor<double, 1> stencil7 = {
+static const gt::stensor<double, 7> stencil7 = {
   -1.0 / 60.0, 3.0 / 20.0, -3.0 / 4.0, 0.0, 3.0 / 4.0, -3.0 / 20.0, 1.0 / 60.0};
 
 inline auto stencil1d_3(const gt::gtensor<double, 1>& y,
-                        const gt::gtensor<double, 1>& stencil)
+                        const gt::stensor<double, 3>& stencil)
 {
   return stencil(0) * y.view(_s(0, -2)) + stencil(1) * y.view(_s(1, -1)) +
          stencil(2) * y.view(_s(2, _));
 }
 
 inline auto stencil1d_5(const gt::gtensor<double, 1>& y,
-                        const gt::gtensor<double, 1>& stencil)
+                        const gt::stensor<double, 5>& stencil)
 {
   return stencil(0) * y.view(_s(0, -4)) + stencil(1) * y.view(_s(1, -3)) +
          stencil(2) * y.view(_s(2, -2)) + stencil(3) * y.view(_s(3, -1)) +
@@ -47,7 +47,7 @@ inline auto stencil1d_5(const gt::gtensor<double, 1>& y,
 }
 
 inline auto stencil1d_7(const gt::gtensor<double, 1>& y,
-                        const gt::gtensor<double, 1>& stencil)
+                        const gt::stensor<double, 7>& stencil)
 {
   return stencil(0) * y.view(_s(0, -6)) + stencil(1) * y.view(_s(1, -5)) +
          stencil(2) * y.view(_s(2, -4)) + stencil(3) * y.view(_s(3, -3)) +
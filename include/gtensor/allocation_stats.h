@@ -0,0 +1,319 @@
+#ifndef GTENSOR_ALLOCATION_STATS_H
+#define GTENSOR_ALLOCATION_STATS_H
+
+#include <array>
+#include <atomic>
+#include <climits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "defs.h"
+#include "space_forward.h"
+
+// ======================================================================
+// allocation statistics
+//
+// Every allocation made through the gtensor allocators (gtensor storage, the
+// built-in pools and the C API) is counted per memory space: live and peak
+// bytes, number of allocations and deallocations, and a histogram of sizes.
+// Since the caching allocator keeps freed blocks, its cache counts as live.
+// Allocations made while a gt::allocation_tag is alive on the same thread are
+// also attributed to that tag, e.g.
+//
+//   {
+//     gt::allocation_tag tag("solver");
+//     ...
+//   }
+//   auto stats = gt::get_allocation_stats(gt::allocation_space::device,
+//                                         "solver");
+//
+// Note that thrust allocators are not covered when GTENSOR_USE_THRUST is set,
+// and in host builds all spaces are counted as host. Counting can be compiled
+// out with GTENSOR_DISABLE_ALLOCATION_STATS.
+
+namespace gt
+{
+
+enum class allocation_space
+{
+  host,
+  host_pinned,
+  device,
+  managed
+};
+
+constexpr int ALLOCATION_SPACES = 4;
+
+// histogram[k] counts allocations of [2^k, 2^(k + 1)) bytes, k = 0 also
+// counting empty ones
+constexpr int ALLOCATION_HISTOGRAM_BINS = sizeof(size_type) * CHAR_BIT;
+
+struct allocation_stats
+{
+  size_type live_bytes = 0;
+  size_type peak_bytes = 0;
+  size_type num_allocations = 0;
+  size_type num_deallocations = 0;
+  std::array<size_type, ALLOCATION_HISTOGRAM_BINS> histogram{};
+};
+
+namespace detail
+{
+
+// ----------------------------------------------------------------------
+// space_allocation_kind
+//
+// which allocation_space the allocations of a gtensor space count towards
+
+template <typename S>
+struct space_allocation_kind
+{
+  static constexpr allocation_space value = allocation_space::device;
+};
+
+template <>
+struct space_allocation_kind<gt::space::host_only>
+{
+  static constexpr allocation_space value = allocation_space::host;
+};
+
+#define GTENSOR_SPACE_ALLOCATION_KIND(S, kind)                                 \
+  template <>                                                                  \
+  struct space_allocation_kind<gt::space::S>                                   \
+  {                                                                            \
+    static constexpr allocation_space value = allocation_space::kind;          \
+  };
+
+#ifdef GTENSOR_HAVE_THRUST
+GTENSOR_SPACE_ALLOCATION_KIND(thrust_host, host_pinned)
+GTENSOR_SPACE_ALLOCATION_KIND(thrust_managed, managed)
+#endif
+#ifdef GTENSOR_DEVICE_CUDA
+GTENSOR_SPACE_ALLOCATION_KIND(cuda_host, host_pinned)
+GTENSOR_SPACE_ALLOCATION_KIND(cuda_managed, managed)
+#endif
+#ifdef GTENSOR_DEVICE_HIP
+GTENSOR_SPACE_ALLOCATION_KIND(hip_host, host_pinned)
+GTENSOR_SPACE_ALLOCATION_KIND(hip_managed, managed)
+#endif
+#ifdef GTENSOR_DEVICE_SYCL
+GTENSOR_SPACE_ALLOCATION_KIND(sycl_host, host_pinned)
+GTENSOR_SPACE_ALLOCATION_KIND(sycl_managed, managed)
+#endif
+
+#undef GTENSOR_SPACE_ALLOCATION_KIND
+
+// ----------------------------------------------------------------------
+// allocation_counters
+
+struct allocation_counters
+{
+  std::atomic<size_type> live_bytes{0};
+  std::atomic<size_type> peak_bytes{0};
+  std::atomic<size_type> num_allocations{0};
+  std::atomic<size_type> num_deallocations{0};
+  std::array<std::atomic<size_type>, ALLOCATION_HISTOGRAM_BINS> histogram{};
+
+  void allocate(size_type nbytes)
+  {
+    size_type live = live_bytes.fetch_add(nbytes) + nbytes;
+    size_type peak = peak_bytes.load(std::memory_order_relaxed);
+    while (peak < live && !peak_bytes.compare_exchange_weak(peak, live)) {
+    }
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    int bin = 0;
+    while (nbytes >>= 1) {
+      bin++;
+    }
+    histogram[bin].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void deallocate(size_type nbytes)
+  {
+    live_bytes.fetch_sub(nbytes);
+    num_deallocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  allocation_stats get() const
+  {
+    allocation_stats stats;
+    stats.live_bytes = live_bytes;
+    stats.peak_bytes = peak_bytes;
+    stats.num_allocations = num_allocations;
+    stats.num_deallocations = num_deallocations;
+    for (int i = 0; i < ALLOCATION_HISTOGRAM_BINS; i++) {
+      stats.histogram[i] = histogram[i];
+    }
+    return stats;
+  }
+};
+
+// ----------------------------------------------------------------------
+// allocation_registry
+
+class allocation_registry
+{
+public:
+  using counters_type = std::array<allocation_counters, ALLOCATION_SPACES>;
+
+  static allocation_registry& instance()
+  {
+    static allocation_registry registry;
+    return registry;
+  }
+
+  allocation_counters& counters(allocation_space space)
+  {
+    return counters_[int(space)];
+  }
+
+  // counters of the tag alive on this thread, if any
+  static counters_type*& current_tag()
+  {
+    static thread_local counters_type* tag = nullptr;
+    return tag;
+  }
+
+  counters_type* get_tag(const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return &tags_[name];
+  }
+
+  // nullptr if there is no such tag
+  const counters_type* find_tag(const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tags_.find(name);
+    return it != tags_.end() ? &it->second : nullptr;
+  }
+
+  std::vector<std::string> tag_names()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (auto& tag : tags_) {
+      names.push_back(tag.first);
+    }
+    return names;
+  }
+
+  void allocate(allocation_space space, const void* p, size_type nbytes)
+  {
+    counters(space).allocate(nbytes);
+    counters_type* tag = current_tag();
+    if (tag) {
+      (*tag)[int(space)].allocate(nbytes);
+      std::lock_guard<std::mutex> lock(mutex_);
+      tagged_.emplace(p, tag);
+      num_tagged_ = tagged_.size();
+    }
+  }
+
+  void deallocate(allocation_space space, const void* p, size_type nbytes)
+  {
+    counters(space).deallocate(nbytes);
+    if (num_tagged_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = tagged_.find(p);
+      if (it != tagged_.end()) {
+        (*it->second)[int(space)].deallocate(nbytes);
+        tagged_.erase(it);
+        num_tagged_ = tagged_.size();
+      }
+    }
+  }
+
+private:
+  counters_type counters_;
+  std::mutex mutex_;
+  // std::map, so the counters never move
+  std::map<std::string, counters_type> tags_;
+  // live tagged allocations
+  std::unordered_map<const void*, counters_type*> tagged_;
+  std::atomic<size_type> num_tagged_{0};
+};
+
+inline void record_allocation(allocation_space space, const void* p,
+                              size_type nbytes)
+{
+#ifndef GTENSOR_DISABLE_ALLOCATION_STATS
+  if (p != nullptr) {
+    allocation_registry::instance().allocate(space, p, nbytes);
+  }
+#endif
+}
+
+inline void record_deallocation(allocation_space space, const void* p,
+                                size_type nbytes)
+{
+#ifndef GTENSOR_DISABLE_ALLOCATION_STATS
+  if (p != nullptr) {
+    allocation_registry::instance().deallocate(space, p, nbytes);
+  }
+#endif
+}
+
+} // namespace detail
+
+// ======================================================================
+// allocation_tag
+//
+// Attributes the allocations made by the constructing thread to name, until
+// the tag is destroyed. Tags nest, the innermost one wins.
+
+class allocation_tag
+{
+public:
+  explicit allocation_tag(const std::string& name)
+    : prev_{detail::allocation_registry::current_tag()}
+  {
+    detail::allocation_registry::current_tag() =
+      detail::allocation_registry::instance().get_tag(name);
+  }
+
+  allocation_tag(const allocation_tag&) = delete;
+  allocation_tag& operator=(const allocation_tag&) = delete;
+
+  ~allocation_tag() { detail::allocation_registry::current_tag() = prev_; }
+
+private:
+  detail::allocation_registry::counters_type* prev_;
+};
+
+// ======================================================================
+// query API
+
+inline allocation_stats get_allocation_stats(allocation_space space)
+{
+  return detail::allocation_registry::instance().counters(space).get();
+}
+
+// statistics of the allocations made under the given tag, all zero if the
+// tag was never used
+inline allocation_stats get_allocation_stats(allocation_space space,
+                                             const std::string& tag)
+{
+  auto counters = detail::allocation_registry::instance().find_tag(tag);
+  return counters ? (*counters)[int(space)].get() : allocation_stats{};
+}
+
+inline std::vector<std::string> get_allocation_tags()
+{
+  return detail::allocation_registry::instance().tag_names();
+}
+
+// restart tracking the peak from the current live bytes
+inline void reset_allocation_peak(allocation_space space)
+{
+  auto& counters = detail::allocation_registry::instance().counters(space);
+  counters.peak_bytes = counters.live_bytes.load();
+}
+
+} // namespace gt
+
+#endif // GTENSOR_ALLOCATION_STATS_H
@@ -1,15 +1,28 @@
 
+#include "device_backend.h"
 #include "meta.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstdint>
 #include <iostream>
-#include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 #ifdef GTENSOR_HAVE_THRUST
 #include <thrust/device_ptr.h>
 #endif
 
+// upper bound on the bytes held by each caching allocator's free lists,
+// beyond which freed blocks go back to the underlying allocator
+#ifndef GTENSOR_ALLOCATOR_CACHE_LIMIT
+#define GTENSOR_ALLOCATOR_CACHE_LIMIT (std::size_t(4) << 30)
+#endif
+
 namespace gt
 {
 namespace allocator
@@ -34,10 +47,80 @@ bool is_valid(::thrust::device_ptr<T> p)
 }
 #endif
 
+// ----------------------------------------------------------------------
+// size classes
+//
+// Requests are rounded up to geometrically spaced classes: everything up to
+// 2^CACHE_MIN_CLASS_BITS bytes shares class 0, above that every power of two
+// is split into 2^CACHE_SUBCLASS_BITS equal steps, so at most 25% of a block
+// is wasted and a freed block can serve any request of the same class.
+
+constexpr int CACHE_MIN_CLASS_BITS = 8;
+constexpr int CACHE_SUBCLASS_BITS = 2;
+constexpr int CACHE_NUM_CLASSES =
+  ((int(sizeof(std::size_t) * CHAR_BIT) - CACHE_MIN_CLASS_BITS)
+   << CACHE_SUBCLASS_BITS) +
+  1;
+
+// classes small enough to be kept in the per-thread caches (up to 1MiB), and
+// how many blocks of each class a thread may hold on to
+constexpr int CACHE_LOCAL_CLASSES =
+  ((20 - CACHE_MIN_CLASS_BITS) << CACHE_SUBCLASS_BITS) + 1;
+constexpr std::size_t CACHE_LOCAL_DEPTH = 4;
+
+inline int highest_bit(std::size_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return int(sizeof(unsigned long long) * CHAR_BIT) - 1 -
+         __builtin_clzll((unsigned long long)x);
+#else
+  int bit = 0;
+  while (x >>= 1) {
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+struct size_class
+{
+  int index;
+  std::size_t nbytes;
+};
+
+inline size_class get_size_class(std::size_t nbytes)
+{
+  constexpr std::size_t min_bytes = std::size_t(1) << CACHE_MIN_CLASS_BITS;
+  if (nbytes <= min_bytes) {
+    return {0, min_bytes};
+  }
+  // 2^octave < nbytes <= 2^(octave + 1)
+  int octave = highest_bit(nbytes - 1);
+  int shift = octave - CACHE_SUBCLASS_BITS;
+  std::size_t base = std::size_t(1) << octave;
+  std::size_t sub = (nbytes - base + (std::size_t(1) << shift) - 1) >> shift;
+  return {((octave - CACHE_MIN_CLASS_BITS) << CACHE_SUBCLASS_BITS) + int(sub),
+          base + (sub << shift)};
+}
+
 } // namespace detail
 
 // ======================================================================
 // caching_allocator
+//
+// Keeps freed blocks in size-class free lists instead of returning them to
+// the underlying allocator A. Small blocks are first cached per thread,
+// without locking; larger blocks, and small ones that overflow a thread's
+// cache, go to free lists shared by all threads, each with its own lock.
+// The bytes held in the cache are bounded by cache_limit(); blocks freed
+// beyond it are released right away.
+//
+// Work in flight may still be using a block when it is deallocated, so each
+// freed block is tagged with an event recorded on the thread's
+// gt::deallocation_stream, and is only handed out again once that event has
+// completed. Allocation takes the oldest such block, and otherwise gets new
+// memory from A; trimming likewise releases only blocks whose work has
+// completed. Neither allocation nor deallocation waits for any stream.
 
 template <class T, class A>
 struct caching_allocator : A
@@ -56,55 +139,69 @@ struct caching_allocator : A
 
   pointer allocate(size_type cnt)
   {
-    pointer p;
-    auto it = free_.find(cnt);
-    if (it != free_.end()) {
-      p = it->second;
-      free_.erase(it);
-#ifdef DEBUG
-      std::cout << "ALLOC: allocating " << cnt << " bytes from cache\n";
-#endif
-    } else {
+    if (cnt == 0) {
+      return base_type::allocate(cnt);
+    }
+    auto cls = detail::get_size_class(cnt * sizeof(value_type));
+    // Note: default constructing the block's event must not create a backend
+    // event, this is on every allocation's path
+    block blk;
+    if (pop(cls.index, blk)) {
+      get_shared().cached_bytes -= cls.nbytes;
 #ifdef DEBUG
-      std::cout << "ALLOC: total used " << used_ * sizeof(T) << ", allocing "
-                << cnt * sizeof(T) << "\n";
+      std::cout << "ALLOC: allocating " << cls.nbytes << " bytes from cache\n";
 #endif
-      p = base_type::allocate(cnt);
-      used_ += cnt;
+      return blk.p;
+    }
 #ifdef DEBUG
-      std::cout << "ALLOC: allocating " << cnt << " bytes\n";
+    std::cout << "ALLOC: allocating " << cls.nbytes << " bytes\n";
 #endif
-    }
-    if (detail::is_valid(p)) {
-      allocated_.emplace(std::make_pair(p, cnt));
-    }
-    return p;
+    return base_type::allocate(class_count(cls.nbytes));
   }
 
   void deallocate(pointer p, size_type cnt)
   {
-    gt::synchronize();
-    if (detail::is_valid(p)) {
-      auto it = allocated_.find(p);
-      assert(it != allocated_.end());
-      free_.emplace(std::make_pair(it->second, p));
-      allocated_.erase(it);
+    if (!detail::is_valid(p)) {
+      return;
+    }
+    if (cnt == 0) {
+      base_type::deallocate(p, cnt);
+      return;
+    }
+    auto cls = detail::get_size_class(cnt * sizeof(value_type));
+    shared_state& shared = get_shared();
+    if (!reserve(shared, cls.nbytes)) {
+      base_type::deallocate(p, class_count(cls.nbytes));
+      return;
+    }
+    block blk{p, gt::deallocation_stream::get().record_event()};
+    if (!push_local(cls.index, blk)) {
+      bin& b = shared.bins[cls.index];
+      std::lock_guard<std::mutex> lock(b.mutex);
+      b.blocks.push_back(std::move(blk));
     }
-#ifdef DEBUG
-    std::cout << "ALLOC: deallocing cnt " << cnt
-              << " #allocated = " << allocated_.size()
-              << " #free = " << free_.size() << "\n";
-#endif
   }
 
   GT_INLINE void construct(pointer) {}
 
-  static void clear_cache()
+  // release the blocks cached by the calling thread and those in the
+  // shared free lists, waiting for work still using them; other threads'
+  // caches are left alone
+  static void clear_cache() { trim(0, true); }
+
+  // release cached blocks whose work has completed, largest classes in the
+  // shared free lists first, then the calling thread's own, until at most
+  // nbytes are cached; blocks still in use stay cached, so this never waits
+  static void trim(std::size_t nbytes) { trim(nbytes, false); }
+
+  static std::size_t cached_bytes() { return get_shared().cached_bytes; }
+
+  static std::size_t cache_limit() { return get_shared().limit; }
+
+  static void set_cache_limit(std::size_t nbytes)
   {
-    for (auto it = free_.begin(); it != free_.end(); it++) {
-      base_type::deallocate(it->second, it->first);
-    }
-    free_.clear();
+    get_shared().limit = nbytes;
+    trim(nbytes);
   }
 
   template <class U>
@@ -114,23 +211,205 @@ struct caching_allocator : A
   };
 
 private:
-  static std::multimap<size_type, pointer> free_;
-  static std::map<pointer, size_type> allocated_;
-  static size_t used_;
-};
+  struct block
+  {
+    pointer p;
+    // marks the work that may still use the block
+    gt::stream_event event;
+  };
 
-template <class T, class A>
-std::multimap<typename caching_allocator<T, A>::size_type,
-              typename caching_allocator<T, A>::pointer>
-  caching_allocator<T, A>::free_;
+  struct bin
+  {
+    std::mutex mutex;
+    std::vector<block> blocks;
+  };
 
-template <class T, class A>
-std::map<typename caching_allocator<T, A>::pointer,
-         typename caching_allocator<T, A>::size_type>
-  caching_allocator<T, A>::allocated_;
+  // Note: blocks still cached at exit are not released, and their events not
+  // destroyed, since the backend may already have been torn down by then
+  struct shared_state
+  {
+    std::array<bin, detail::CACHE_NUM_CLASSES> bins;
+    std::atomic<std::size_t> cached_bytes{0};
+    std::atomic<std::size_t> limit{GTENSOR_ALLOCATOR_CACHE_LIMIT};
+  };
 
-template <class T, class A>
-size_t caching_allocator<T, A>::used_;
+  struct local_cache
+  {
+    std::array<std::vector<block>, detail::CACHE_LOCAL_CLASSES> bins;
+
+    // hand the blocks over to the shared free lists when the thread exits
+    ~local_cache()
+    {
+      local_destroyed() = true;
+      shared_state& shared = get_shared();
+      for (int i = 0; i < detail::CACHE_LOCAL_CLASSES; i++) {
+        if (!bins[i].empty()) {
+          bin& b = shared.bins[i];
+          std::lock_guard<std::mutex> lock(b.mutex);
+          b.blocks.insert(b.blocks.end(),
+                          std::make_move_iterator(bins[i].begin()),
+                          std::make_move_iterator(bins[i].end()));
+        }
+      }
+    }
+  };
+
+  static shared_state& get_shared()
+  {
+    static shared_state* shared = new shared_state;
+    return *shared;
+  }
+
+  static bool& local_destroyed()
+  {
+    static thread_local bool destroyed = false;
+    return destroyed;
+  }
+
+  // the calling thread's cache, or nullptr once it has been destroyed, e.g.
+  // when static objects are deallocated at exit
+  static local_cache* get_local()
+  {
+    if (local_destroyed()) {
+      return nullptr;
+    }
+    static thread_local local_cache local;
+    return &local;
+  }
+
+  // number of elements to allocate for a block of a class
+  static size_type class_count(std::size_t nbytes)
+  {
+    return (nbytes + sizeof(value_type) - 1) / sizeof(value_type);
+  }
+
+  // take the oldest block in list whose work has completed
+  static bool take(std::vector<block>& list, block& blk)
+  {
+    auto it = std::find_if(list.begin(), list.end(),
+                           [](const block& b) { return b.event.query(); });
+    if (it == list.end()) {
+      return false;
+    }
+    blk = std::move(*it);
+    list.erase(it);
+    return true;
+  }
+
+  // a cached block of the class that is no longer in use, preferring the
+  // calling thread's cache; false if every cached block is still in use
+  static bool pop(int index, block& blk)
+  {
+    if (index < detail::CACHE_LOCAL_CLASSES) {
+      local_cache* local = get_local();
+      if (local && take(local->bins[index], blk)) {
+        return true;
+      }
+    }
+    bin& b = get_shared().bins[index];
+    std::lock_guard<std::mutex> lock(b.mutex);
+    return take(b.blocks, blk);
+  }
+
+  static bool push_local(int index, block& blk)
+  {
+    if (index >= detail::CACHE_LOCAL_CLASSES) {
+      return false;
+    }
+    local_cache* local = get_local();
+    if (!local || local->bins[index].size() >= detail::CACHE_LOCAL_DEPTH) {
+      return false;
+    }
+    local->bins[index].push_back(std::move(blk));
+    return true;
+  }
+
+  // account for nbytes more in the cache, trimming the shared free lists if
+  // that would exceed the limit; false if the block should not be cached
+  static bool reserve(shared_state& shared, std::size_t nbytes)
+  {
+    std::size_t limit = shared.limit;
+    if (nbytes > limit) {
+      return false;
+    }
+    if (shared.cached_bytes.fetch_add(nbytes) + nbytes <= limit) {
+      return true;
+    }
+    shared.cached_bytes -= nbytes;
+    trim(limit - nbytes);
+    if (shared.cached_bytes.fetch_add(nbytes) + nbytes <= limit) {
+      return true;
+    }
+    shared.cached_bytes -= nbytes;
+    return false;
+  }
+
+  static void trim(std::size_t nbytes, bool wait)
+  {
+    shared_state& shared = get_shared();
+    for (int i = detail::CACHE_NUM_CLASSES - 1;
+         i >= 0 && shared.cached_bytes.load() > nbytes; i--) {
+      // freeing the blocks happens outside the lock, so other threads using
+      // the class are not held up; the ones still in use go back in front,
+      // being older than any freed in the meantime
+      std::vector<block> blocks;
+      bin& b = shared.bins[i];
+      {
+        std::lock_guard<std::mutex> lock(b.mutex);
+        blocks.swap(b.blocks);
+      }
+      shared.cached_bytes -= release(i, blocks, wait);
+      if (!blocks.empty()) {
+        std::lock_guard<std::mutex> lock(b.mutex);
+        b.blocks.insert(b.blocks.begin(),
+                        std::make_move_iterator(blocks.begin()),
+                        std::make_move_iterator(blocks.end()));
+      }
+    }
+    local_cache* local = get_local();
+    for (int i = detail::CACHE_LOCAL_CLASSES - 1;
+         local && i >= 0 && shared.cached_bytes.load() > nbytes; i--) {
+      shared.cached_bytes -= release(i, local->bins[i], wait);
+    }
+  }
+
+  // return the blocks in list to the underlying allocator, giving the number
+  // of bytes released; unless wait, blocks still in use are kept in list
+  static std::size_t release(int index, std::vector<block>& list, bool wait)
+  {
+    std::size_t nbytes = class_bytes(index);
+    A alloc;
+    std::size_t n = 0;
+    auto keep = list.begin();
+    for (auto it = list.begin(); it != list.end(); ++it) {
+      if (wait) {
+        it->event.synchronize();
+      } else if (!it->event.query()) {
+        if (keep != it) {
+          *keep = std::move(*it);
+        }
+        ++keep;
+        continue;
+      }
+      alloc.deallocate(it->p, class_count(nbytes));
+      n++;
+    }
+    list.erase(keep, list.end());
+    return n * nbytes;
+  }
+
+  static std::size_t class_bytes(int index)
+  {
+    if (index == 0) {
+      return std::size_t(1) << detail::CACHE_MIN_CLASS_BITS;
+    }
+    int octave = (index - 1) / (1 << detail::CACHE_SUBCLASS_BITS) +
+                 detail::CACHE_MIN_CLASS_BITS;
+    int sub = (index - 1) % (1 << detail::CACHE_SUBCLASS_BITS) + 1;
+    return (std::size_t(1) << octave) +
+           (std::size_t(sub) << (octave - detail::CACHE_SUBCLASS_BITS));
+  }
+};
 
 template <class T, class AT, class U, class AU>
 inline bool operator==(const caching_allocator<T, AT>&,
@@ -2,6 +2,7 @@
 #ifndef GTENSOR_ASSIGN_H
 #define GTENSOR_ASSIGN_H
 
+#include <algorithm>
 #include <type_traits>
 
 #include "defs.h"
@@ -10,10 +11,22 @@
 namespace gt
 {
 
+template <typename T>
+class gscalar;
+
+template <typename F, typename E1, typename E2>
+class gfunction;
+
+struct gt_empty_expr;
+
 constexpr const int BS_X = 16;
 constexpr const int BS_Y = 16;
 constexpr const int BS_LINEAR = 256;
 
+// edge length of the tiles used by the host assign when the operands are
+// laid out along different dimensions
+constexpr const size_type HOST_ASSIGN_TILE = 32;
+
 // ======================================================================
 // assign
 
@@ -26,111 +39,575 @@ struct assigner
   static_assert(!std::is_same<SP, SP>::value, "assigner not implemented.");
 };
 
-template <>
-struct assigner<1, space::host>
+// ----------------------------------------------------------------------
+// host_assign_loop
+//
+// nested loops over the index box [lo, hi), innermost dimension first
+
+template <size_type D>
+struct host_assign_loop
 {
-  template <typename E1, typename E2>
-  static void run(E1& lhs, const E2& rhs, stream_view stream)
+  template <typename E1, typename E2, typename S>
+  static void run(E1& lhs, const E2& rhs, S& idx, const S& lo, const S& hi)
   {
-    // printf("assigner<1, host>\n");
-    for (int i = 0; i < lhs.shape(0); i++) {
-      lhs(i) = rhs(i);
+    for (idx[D - 1] = lo[D - 1]; idx[D - 1] < hi[D - 1]; idx[D - 1]++) {
+      host_assign_loop<D - 1>::run(lhs, rhs, idx, lo, hi);
     }
   }
 };
 
 template <>
-struct assigner<2, space::host>
+struct host_assign_loop<0>
 {
-  template <typename E1, typename E2>
-  static void run(E1& lhs, const E2& rhs, stream_view stream)
+  template <typename E1, typename E2, typename S>
+  static void run(E1& lhs, const E2& rhs, S& idx, const S&, const S&)
   {
-    // printf("assigner<2, host>\n");
-    for (int j = 0; j < lhs.shape(1); j++) {
-      for (int i = 0; i < lhs.shape(0); i++) {
-        lhs(i, j) = rhs(i, j);
+    index_expression(lhs, idx) = index_expression(rhs, idx);
+  }
+};
+
+// ----------------------------------------------------------------------
+// host_pack
+//
+// Fixed width group of values that the contiguous host assign evaluates an
+// expression tree on at once. Operations are applied lane by lane in loops
+// of compile time length, which the compiler turns into vector instructions
+// where the target supports them (real arithmetic, and the real and
+// imaginary parts of gt::complex).
+
+#ifndef GTENSOR_HOST_SIMD_BYTES
+#define GTENSOR_HOST_SIMD_BYTES 64
+#endif
+
+// number of lanes per pack for value type T, between 4 and 16
+template <typename T>
+constexpr int host_pack_width()
+{
+  return GTENSOR_HOST_SIMD_BYTES / sizeof(T) < 4
+           ? 4
+           : (GTENSOR_HOST_SIMD_BYTES / sizeof(T) > 16
+                ? 16
+                : GTENSOR_HOST_SIMD_BYTES / sizeof(T));
+}
+
+template <typename T, int W>
+struct host_pack
+{
+  T lanes[W];
+};
+
+// ----------------------------------------------------------------------
+// host_strided_evaluator
+//
+// Evaluates an expression along runs of elements without going through the
+// multi-index operator(). Leaves whose data_access(i) is a plain strided
+// access (containers, spans and views of those) keep their own strides and
+// offset, scalars are constant, and gfunctions combine their operands.
+// For other expressions, enabled is false and the host assign falls back to
+// host_assign_loop.
+//
+// After collapse(), dimension g of the evaluator corresponds to original
+// dimension dims[g]. seek() positions the evaluator at the given index in
+// the outer dimensions, and get(i) then returns the element at index i along
+// dimension 0. If dimension 0 has unit stride, get_contiguous(i) and
+// get_pack<W>(i) may be used instead, the latter returning elements i to
+// i + W - 1.
+
+// true for expressions whose data_access(i) directly indexes strided memory
+template <typename E, typename Enable = void>
+struct has_strided_data_access : std::false_type
+{};
+
+template <typename E, typename Enable = void>
+struct host_strided_evaluator
+{
+  constexpr static bool enabled = false;
+};
+
+template <typename E>
+struct host_strided_evaluator<
+  E, std::enable_if_t<has_strided_data_access<std::remove_const_t<E>>::value>>
+{
+  constexpr static bool enabled = true;
+  using strides_type = std::decay_t<decltype(std::declval<E&>().strides())>;
+
+  explicit host_strided_evaluator(E& e) : e_(e), strides_(e.strides())
+  {
+    // dimensions of extent 1 are broadcast, so must not advance
+    const auto shape = e.shape();
+    for (size_type d = 0; d < strides_.size(); d++) {
+      if (shape[d] == 1) {
+        strides_[d] = 0;
       }
     }
   }
+
+  template <typename P>
+  bool all_strides(P&& pred) const
+  {
+    return pred(strides_);
+  }
+
+  template <typename S>
+  void collapse(const S& dims, int ndim)
+  {
+    strides_type strides;
+    for (int g = 0; g < ndim; g++) {
+      strides[g] = strides_[dims[g]];
+    }
+    strides_ = strides;
+  }
+
+  template <typename S>
+  void seek(const S& idx, int ndim)
+  {
+    offset_ = 0;
+    for (int g = 1; g < ndim && g < int(idx.size()); g++) {
+      offset_ += size_type(strides_[g]) * idx[g];
+    }
+  }
+
+  decltype(auto) get(size_type i) const
+  {
+    return e_.data_access(offset_ + i * size_type(strides_[0]));
+  }
+
+  // for use when strides_[0] == 1
+  decltype(auto) get_contiguous(size_type i) const
+  {
+    return e_.data_access(offset_ + i);
+  }
+
+  template <int W>
+  auto get_pack(size_type i) const
+  {
+    host_pack<std::decay_t<decltype(get_contiguous(i))>, W> pack;
+    for (int l = 0; l < W; l++) {
+      pack.lanes[l] = e_.data_access(offset_ + i + l);
+    }
+    return pack;
+  }
+
+private:
+  E& e_;
+  strides_type strides_;
+  size_type offset_ = 0;
 };
 
-template <>
-struct assigner<3, space::host>
+template <typename T>
+struct host_strided_evaluator<const gscalar<T>>
 {
-  template <typename E1, typename E2>
-  static void run(E1& lhs, const E2& rhs, stream_view stream)
+  constexpr static bool enabled = true;
+  using value_type = typename gscalar<T>::value_type;
+
+  explicit host_strided_evaluator(const gscalar<T>& e) : value_(e()) {}
+
+  template <typename P>
+  bool all_strides(P&&) const
   {
-    // printf("assigner<3, host>\n");
-    for (int k = 0; k < lhs.shape(2); k++) {
-      for (int j = 0; j < lhs.shape(1); j++) {
-        for (int i = 0; i < lhs.shape(0); i++) {
-          lhs(i, j, k) = rhs(i, j, k);
-        }
-      }
+    return true;
+  }
+
+  template <typename S>
+  void collapse(const S&, int)
+  {}
+
+  template <typename S>
+  void seek(const S&, int)
+  {}
+
+  value_type get(size_type) const { return value_; }
+  value_type get_contiguous(size_type) const { return value_; }
+
+  template <int W>
+  host_pack<value_type, W> get_pack(size_type) const
+  {
+    host_pack<value_type, W> pack;
+    for (int l = 0; l < W; l++) {
+      pack.lanes[l] = value_;
     }
+    return pack;
   }
+
+private:
+  value_type value_;
 };
 
-template <>
-struct assigner<4, space::host>
+template <typename F, typename E>
+struct host_strided_evaluator<const gfunction<F, E, gt_empty_expr>>
 {
-  template <typename E1, typename E2>
-  static void run(E1& lhs, const E2& rhs, stream_view stream)
+  using eval_type = host_strided_evaluator<const std::remove_reference_t<E>>;
+
+  constexpr static bool enabled = eval_type::enabled;
+
+  explicit host_strided_evaluator(const gfunction<F, E, gt_empty_expr>& e)
+    : f_(e.f_), e_(e.e_)
+  {}
+
+  template <typename P>
+  bool all_strides(P&& pred) const
   {
-    // printf("assigner<4, host>\n");
-    for (int l = 0; l < lhs.shape(3); l++) {
-      for (int k = 0; k < lhs.shape(2); k++) {
-        for (int j = 0; j < lhs.shape(1); j++) {
-          for (int i = 0; i < lhs.shape(0); i++) {
-            lhs(i, j, k, l) = rhs(i, j, k, l);
-          }
-        }
-      }
+    return e_.all_strides(pred);
+  }
+
+  template <typename S>
+  void collapse(const S& dims, int ndim)
+  {
+    e_.collapse(dims, ndim);
+  }
+
+  template <typename S>
+  void seek(const S& idx, int ndim)
+  {
+    e_.seek(idx, ndim);
+  }
+
+  decltype(auto) get(size_type i) const { return f_(e_.get(i)); }
+
+  decltype(auto) get_contiguous(size_type i) const
+  {
+    return f_(e_.get_contiguous(i));
+  }
+
+  template <int W>
+  auto get_pack(size_type i) const
+  {
+    auto a = e_.template get_pack<W>(i);
+    host_pack<std::decay_t<decltype(f_(a.lanes[0]))>, W> pack;
+    for (int l = 0; l < W; l++) {
+      pack.lanes[l] = f_(a.lanes[l]);
     }
+    return pack;
   }
+
+private:
+  F f_;
+  eval_type e_;
 };
 
-template <>
-struct assigner<5, space::host>
+template <typename F, typename E1, typename E2>
+struct host_strided_evaluator<const gfunction<F, E1, E2>>
 {
-  template <typename E1, typename E2>
-  static void run(E1& lhs, const E2& rhs, stream_view stream)
+  using eval1_type = host_strided_evaluator<const std::remove_reference_t<E1>>;
+  using eval2_type = host_strided_evaluator<const std::remove_reference_t<E2>>;
+
+  constexpr static bool enabled = eval1_type::enabled && eval2_type::enabled;
+
+  explicit host_strided_evaluator(const gfunction<F, E1, E2>& e)
+    : f_(e.f_), e1_(e.e1_), e2_(e.e2_)
+  {}
+
+  template <typename P>
+  bool all_strides(P&& pred) const
   {
-    // printf("assigner<5, host>\n");
-    for (int m = 0; m < lhs.shape(4); m++) {
-      for (int l = 0; l < lhs.shape(3); l++) {
-        for (int k = 0; k < lhs.shape(2); k++) {
-          for (int j = 0; j < lhs.shape(1); j++) {
-            for (int i = 0; i < lhs.shape(0); i++) {
-              lhs(i, j, k, l, m) = rhs(i, j, k, l, m);
-            }
-          }
-        }
-      }
+    return e1_.all_strides(pred) && e2_.all_strides(pred);
+  }
+
+  template <typename S>
+  void collapse(const S& dims, int ndim)
+  {
+    e1_.collapse(dims, ndim);
+    e2_.collapse(dims, ndim);
+  }
+
+  template <typename S>
+  void seek(const S& idx, int ndim)
+  {
+    e1_.seek(idx, ndim);
+    e2_.seek(idx, ndim);
+  }
+
+  decltype(auto) get(size_type i) const { return f_(e1_.get(i), e2_.get(i)); }
+
+  decltype(auto) get_contiguous(size_type i) const
+  {
+    return f_(e1_.get_contiguous(i), e2_.get_contiguous(i));
+  }
+
+  template <int W>
+  auto get_pack(size_type i) const
+  {
+    auto a = e1_.template get_pack<W>(i);
+    auto b = e2_.template get_pack<W>(i);
+    host_pack<std::decay_t<decltype(f_(a.lanes[0], b.lanes[0]))>, W> pack;
+    for (int l = 0; l < W; l++) {
+      pack.lanes[l] = f_(a.lanes[l], b.lanes[l]);
     }
+    return pack;
   }
+
+private:
+  F f_;
+  eval1_type e1_;
+  eval2_type e2_;
 };
 
-template <>
-struct assigner<6, space::host>
+// Merges each dimension of extent > 1 into the previous non-trivial dimension
+// if it continues the same run of elements in all operands, i.e. if
+// all_strides(pred) holds for pred checking that on the operand strides.
+// Returns the number of merged dimensions; merged dimension g has extent
+// cshape[g] and corresponds to original dimension dims[g], as expected by
+// host_strided_evaluator::collapse().
+template <typename S, typename AllStrides, typename D, typename C>
+inline int host_collapse_dims(const S& shape, AllStrides&& all_strides,
+                              D& dims, C& cshape)
+{
+  int ndim = 0;
+  int last = -1;
+  for (int d = 0; d < int(shape.size()); d++) {
+    if (shape[d] == 1) {
+      continue;
+    }
+    auto consecutive = [&](const auto& strides) {
+      return strides[d] == strides[last] * shape[last];
+    };
+    if (last >= 0 && all_strides(consecutive)) {
+      cshape[ndim - 1] *= shape[d];
+    } else {
+      dims[ndim] = d;
+      cshape[ndim] = shape[d];
+      ndim++;
+    }
+    last = d;
+  }
+  if (ndim == 0) {
+    dims[0] = 0;
+    cshape[0] = 1;
+    ndim = 1;
+  }
+  return ndim;
+}
+
+// The host assign partitions the outermost dimension with extent > 1 across
+// the host workers, such that each worker gets at least HOST_ASSIGN_GRAIN
+// elements.
+//
+// If all operands support strided evaluation, adjacent dimensions that are
+// laid out consecutively in every operand are first merged, so that e.g.
+// contiguous arrays are assigned in a single linear loop.
+template <size_type N>
+struct assigner<N, space::host>
 {
   template <typename E1, typename E2>
   static void run(E1& lhs, const E2& rhs, stream_view stream)
   {
-    // printf("assigner<6, host>\n");
-    for (int n = 0; n < lhs.shape(5); n++) {
-      for (int m = 0; m < lhs.shape(4); m++) {
-        for (int l = 0; l < lhs.shape(3); l++) {
-          for (int k = 0; k < lhs.shape(2); k++) {
-            for (int j = 0; j < lhs.shape(1); j++) {
-              for (int i = 0; i < lhs.shape(0); i++) {
-                lhs(i, j, k, l, m, n) = rhs(i, j, k, l, m, n);
-              }
+    if (calc_size(lhs.shape()) == 0) {
+      return;
+    }
+
+    // the kernel of a stensor, or of a view of one, is a copy of its
+    // elements, so a queued task would assign to that copy; assign in place
+    // once the work queued before it is done instead
+    constexpr bool lhs_by_value =
+      std::is_same<expr_space_type<E1>, space::any>::value;
+
+    if (gt::detail::is_async_host_stream(stream) && lhs_by_value) {
+      gt::detail::host_stream_wait(stream);
+      run_now(lhs, rhs);
+    } else if (gt::detail::is_async_host_stream(stream)) {
+      // the queued task outlives the caller's expression objects, so it
+      // works on kernel views of the operands
+      auto k_lhs = lhs.to_kernel();
+      auto k_rhs = rhs.to_kernel();
+      gt::detail::host_stream_submit(
+        stream, [k_lhs, k_rhs]() mutable { run_now(k_lhs, k_rhs); });
+    } else {
+      run_now(lhs, rhs);
+    }
+  }
+
+private:
+  template <typename E1, typename E2>
+  static void run_now(E1& lhs, const E2& rhs)
+  {
+    using strided =
+      std::integral_constant<bool, host_strided_evaluator<E1>::enabled &&
+                                     host_strided_evaluator<const E2>::enabled>;
+    run(lhs, rhs, strided{});
+  }
+
+  // evaluate whole packs of the rhs, then the remainder one element at a time
+  template <typename L, typename R>
+  static void assign_contiguous(const L& l, const R& r, size_type begin,
+                                size_type end)
+  {
+    using value_type = std::decay_t<decltype(l.get_contiguous(begin))>;
+    constexpr int W = host_pack_width<value_type>();
+
+    size_type i = begin;
+    for (; i + W <= end; i += W) {
+      auto pack = r.template get_pack<W>(i);
+      for (int lane = 0; lane < W; lane++) {
+        l.get_contiguous(i + lane) = pack.lanes[lane];
+      }
+    }
+    for (; i < end; i++) {
+      l.get_contiguous(i) = r.get_contiguous(i);
+    }
+  }
+
+  // assign elements [begin, end) of the current row
+  template <typename L, typename R>
+  static void assign_row(const L& l, const R& r, size_type begin,
+                         size_type end, bool contiguous)
+  {
+    if (contiguous) {
+      assign_contiguous(l, r, begin, end);
+    } else {
+      for (size_type i = begin; i < end; i++) {
+        l.get(i) = r.get(i);
+      }
+    }
+  }
+
+  template <typename E1, typename E2>
+  static void run(E1& lhs, const E2& rhs, std::false_type)
+  {
+    using shape_type = gt::shape_type<N>;
+    const shape_type shape = lhs.shape();
+    const size_type size = calc_size(shape);
+
+    int d = N - 1;
+    while (d > 0 && shape[d] == 1) {
+      d--;
+    }
+    size_type grain = gt::div_ceil(HOST_ASSIGN_GRAIN, size / shape[d]);
+
+    gt::backend::host::parallel_for(
+      shape[d], grain, [&](size_type begin, size_type end) {
+        shape_type idx, lo, hi = shape;
+        lo[d] = begin;
+        hi[d] = end;
+        host_assign_loop<N>::run(lhs, rhs, idx, lo, hi);
+      });
+  }
+
+  template <typename E1, typename E2>
+  static void run(E1& lhs, const E2& rhs, std::true_type)
+  {
+    run_strided(lhs, rhs, std::integral_constant<bool, (N > 1)>{});
+  }
+
+  // rank 1: there is nothing to collapse or tile, the single row is split
+  // across the workers directly
+  template <typename E1, typename E2>
+  static void run_strided(E1& lhs, const E2& rhs, std::false_type)
+  {
+    const host_strided_evaluator<E1> lhs_eval(lhs);
+    const host_strided_evaluator<const E2> rhs_eval(rhs);
+
+    auto unit_stride = [](const auto& strides) { return strides[0] == 1; };
+    const bool contiguous =
+      lhs_eval.all_strides(unit_stride) && rhs_eval.all_strides(unit_stride);
+
+    gt::backend::host::parallel_for(
+      lhs.shape(0), HOST_ASSIGN_GRAIN, [&](size_type begin, size_type end) {
+        assign_row(lhs_eval, rhs_eval, begin, end, contiguous);
+      });
+  }
+
+  template <typename E1, typename E2>
+  static void run_strided(E1& lhs, const E2& rhs, std::true_type)
+  {
+    using index_type = sarray<size_type, N>;
+    const auto shape = lhs.shape();
+    const size_type size = calc_size(shape);
+
+    host_strided_evaluator<E1> lhs_eval(lhs);
+    host_strided_evaluator<const E2> rhs_eval(rhs);
+
+    sarray<int, N> dims;
+    index_type cshape;
+    const int ndim = host_collapse_dims(
+      shape,
+      [&](auto&& pred) {
+        return lhs_eval.all_strides(pred) && rhs_eval.all_strides(pred);
+      },
+      dims, cshape);
+
+    lhs_eval.collapse(dims, ndim);
+    rhs_eval.collapse(dims, ndim);
+
+    auto unit_stride = [](const auto& strides) { return strides[0] == 1; };
+    const bool contiguous =
+      lhs_eval.all_strides(unit_stride) && rhs_eval.all_strides(unit_stride);
+
+    // if some operand runs contiguously along an outer dimension q, e.g. when
+    // assigning from a transpose, walking dimension 0 innermost strides
+    // through that operand, so traverse dimensions 0 and q in tiles instead
+    int q = 0;
+    if (!contiguous && cshape[0] >= HOST_ASSIGN_TILE) {
+      for (int g = 1; g < ndim && q == 0; g++) {
+        auto non_unit_stride = [&](const auto& strides) {
+          return strides[g] != 1 && strides[g] != -1;
+        };
+        if (cshape[g] >= HOST_ASSIGN_TILE &&
+            !(lhs_eval.all_strides(non_unit_stride) &&
+              rhs_eval.all_strides(non_unit_stride))) {
+          q = g;
+        }
+      }
+    }
+
+    const int p = ndim - 1;
+    size_type grain = gt::div_ceil(HOST_ASSIGN_GRAIN, size / cshape[p]);
+
+    gt::backend::host::parallel_for(
+      cshape[p], grain, [&](size_type begin, size_type end) {
+        auto l = lhs_eval;
+        auto r = rhs_eval;
+        index_type lo, hi = cshape;
+        lo[p] = begin;
+        hi[p] = end;
+        index_type idx = lo;
+        while (true) {
+          if (q > 0) {
+            assign_tiled(l, r, idx, lo, hi, q, ndim);
+          } else {
+            l.seek(idx, ndim);
+            r.seek(idx, ndim);
+            assign_row(l, r, lo[0], hi[0], contiguous);
+          }
+
+          // ndim <= N, bounding by N as well lets the compiler see that
+          int g = 1;
+          for (; g < ndim && g < int(N); g++) {
+            if (g == q) {
+              continue;
             }
+            if (++idx[g] < hi[g]) {
+              break;
+            }
+            idx[g] = lo[g];
+          }
+          if (g >= ndim) {
+            break;
+          }
+        }
+      });
+  }
+
+  // assign the [lo, hi) box of dimensions 0 and q, at the current idx in the
+  // other dimensions, in HOST_ASSIGN_TILE^2 tiles
+  template <typename L, typename R, typename I>
+  static void assign_tiled(L& l, R& r, I& idx, const I& lo, const I& hi, int q,
+                           int ndim)
+  {
+    for (size_type jb = lo[q]; jb < hi[q]; jb += HOST_ASSIGN_TILE) {
+      size_type je = std::min<size_type>(jb + HOST_ASSIGN_TILE, hi[q]);
+      for (size_type ib = lo[0]; ib < hi[0]; ib += HOST_ASSIGN_TILE) {
+        size_type ie = std::min<size_type>(ib + HOST_ASSIGN_TILE, hi[0]);
+        for (size_type j = jb; j < je; j++) {
+          idx[q] = j;
+          l.seek(idx, ndim);
+          r.seek(idx, ndim);
+          for (size_type i = ib; i < ie; i++) {
+            l.get(i) = r.get(i);
           }
         }
       }
     }
+    idx[q] = lo[q];
   }
 };
 
@@ -0,0 +1,230 @@
+#ifndef GTENSOR_ASYNC_WRITER_H
+#define GTENSOR_ASYNC_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gtensor.h"
+#include "npy.h"
+
+namespace gt
+{
+
+namespace io
+{
+
+// ======================================================================
+// async_writer
+//
+// Writes snapshots of arrays to .npy files on a background thread, so that
+// the time loop only pays for copying them into a staging buffer, e.g.
+//
+//   gt::io::async_writer writer; // double-buffered
+//   for (int step = 0; step < nsteps; step++) {
+//     advance(phi);
+//     if (step % 100 == 0) {
+//       writer.write("phi_" + std::to_string(step) + ".npy", phi);
+//     }
+//   }
+//   writer.wait();
+//
+// Staging buffers are host memory, which is pinned in device builds. When
+// all of them are still being written, write() blocks until one is free, so
+// that output that cannot keep up slows the loop down rather than using
+// unbounded memory. Errors from the background thread are rethrown by the
+// next call to write() or wait().
+//
+// The copy into the staging buffer is done before write() returns, unless a
+// stream is given and the source is contiguous, in which case it is ordered
+// on that stream like other work submitted to it, and the file is written
+// once it completes.
+
+class async_writer
+{
+public:
+  explicit async_writer(int nbuffers = 2) : buffers_(nbuffers)
+  {
+    for (int i = 0; i < nbuffers; i++) {
+      free_.push_back(i);
+    }
+    thread_ = std::thread([this] { run(); });
+  }
+
+  async_writer(const async_writer&) = delete;
+  async_writer& operator=(const async_writer&) = delete;
+
+  // finishes writing all snapshots, errors are ignored
+  ~async_writer()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  template <typename E>
+  void write(const std::string& path, const E& e,
+             gt::stream_view stream = gt::stream_view{})
+  {
+    using T = std::remove_const_t<gt::expr_value_type<E>>;
+    constexpr auto N = gt::expr_dimension<E>();
+
+    int b = acquire();
+    job j;
+    j.path = path;
+    j.buffer = b;
+    j.nbytes = calc_size(e.shape()) * sizeof(T);
+    j.header =
+      gt::detail::npy_make_header(gt::detail::npy_descr<T>::get(),
+                                  gt::detail::npy_shape(e));
+    try {
+      auto& buf = buffers_[b];
+      if (buf.size() < j.nbytes) {
+        buf = gt::gtensor<char, 1>(gt::shape(j.nbytes));
+      }
+      auto staging = gt::adapt<N>(reinterpret_cast<T*>(buf.data()), e.shape());
+      stage(e, staging, stream, gt::has_data_and_size<E>{});
+      j.event = stream.record_event();
+    } catch (...) {
+      release(b);
+      throw;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(std::move(j));
+      pending_++;
+    }
+    cv_.notify_all();
+  }
+
+  // waits until all snapshots written so far are in their files
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return pending_ == 0; });
+    rethrow_error();
+  }
+
+  int nbuffers() const { return int(buffers_.size()); }
+
+private:
+  struct job
+  {
+    std::string path;
+    std::string header;
+    int buffer;
+    std::size_t nbytes;
+    gt::stream_event event;
+  };
+
+  template <typename E, typename S>
+  static void stage(const E& e, S& staging, gt::stream_view stream,
+                    std::true_type)
+  {
+    if (e.is_f_contiguous()) {
+      gt::copy_n(e.data(), e.size(), staging.data(), stream);
+    } else {
+      stage(e, staging, stream, std::false_type{});
+    }
+  }
+
+  template <typename E, typename S>
+  static void stage(const E& e, S& staging, gt::stream_view stream,
+                    std::false_type)
+  {
+    // e may depend on work queued on stream
+    stream.synchronize();
+    gt::copy(e, staging);
+  }
+
+  // index of a free buffer, waiting for one if necessary
+  int acquire()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !free_.empty() || error_; });
+    rethrow_error();
+    int b = free_.back();
+    free_.pop_back();
+    return b;
+  }
+
+  void release(int b)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.push_back(b);
+    }
+    cv_.notify_all();
+  }
+
+  // with mutex_ held
+  void rethrow_error()
+  {
+    if (error_) {
+      auto error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  void run()
+  {
+    while (true) {
+      job j;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) {
+          return;
+        }
+        j = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+
+      std::exception_ptr error;
+      try {
+        j.event.synchronize();
+        gt::detail::npy_write_file(j.path, j.header, buffers_[j.buffer].data(),
+                                   j.nbytes);
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error && !error_) {
+          error_ = error;
+        }
+        free_.push_back(j.buffer);
+        pending_--;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  std::vector<gt::gtensor<char, 1>> buffers_;
+  std::vector<int> free_;
+  std::deque<job> jobs_;
+  int pending_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+
+} // namespace io
+
+} // namespace gt
+
+#endif // GTENSOR_ASYNC_WRITER_H
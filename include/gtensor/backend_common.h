@@ -15,6 +15,7 @@
 
 #endif // GTENSOR_HAVE_DEVICE
 
+#include "allocation_stats.h"
 #include "defs.h"
 #include "macros.h"
 #include "pointer_traits.h"
@@ -271,13 +272,28 @@ struct wrap_allocator
   using pointer = gt::space_pointer<T, S>;
   using size_type = gt::size_type;
 
-  pointer allocate(size_type n) { return pointer(A::template allocate<T>(n)); }
+  pointer allocate(size_type n)
+  {
+    T* p = A::template allocate<T>(n);
+    gt::detail::record_allocation(kind, p, n * sizeof(T));
+    return pointer(p);
+  }
+
   void deallocate(pointer p, size_type n)
   {
-    A::deallocate(gt::pointer_traits<pointer>::get(p));
+    T* raw = gt::pointer_traits<pointer>::get(p);
+    gt::detail::record_deallocation(kind, raw, n * sizeof(T));
+    A::deallocate(raw);
   }
+
+private:
+  static constexpr gt::allocation_space kind =
+    gt::detail::space_allocation_kind<S>::value;
 };
 
+template <typename T, typename A, typename S>
+constexpr gt::allocation_space wrap_allocator<T, A, S>::kind;
+
 template <typename S>
 struct gallocator;
 
@@ -276,6 +276,65 @@ public:
       cudaMemcpyAsync(dst, src, sizeof(T) * count, cudaMemcpyDeviceToDevice));
   }
 
+  // marks the work submitted to a stream up to when it was recorded; the
+  // handle is only created when first recorded, so default constructing an
+  // event is cheap, and an event never recorded counts as completed
+  class event
+  {
+  public:
+    event() = default;
+
+    ~event()
+    {
+      if (event_) {
+        gtGpuCheck(cudaEventDestroy(event_));
+      }
+    }
+
+    event(const event&) = delete;
+    event& operator=(const event&) = delete;
+
+    event(event&& other) : event_(other.event_) { other.event_ = nullptr; }
+
+    event& operator=(event&& other)
+    {
+      std::swap(event_, other.event_);
+      return *this;
+    }
+
+    void record(cudaStream_t stream)
+    {
+      if (!event_) {
+        gtGpuCheck(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
+      }
+      gtGpuCheck(cudaEventRecord(event_, stream));
+    }
+
+    // true if the marked work has completed
+    bool query() const
+    {
+      if (!event_) {
+        return true;
+      }
+      auto err = cudaEventQuery(event_);
+      if (err == cudaErrorNotReady) {
+        return false;
+      }
+      gtGpuCheck(err);
+      return true;
+    }
+
+    void synchronize() const
+    {
+      if (event_) {
+        gtGpuCheck(cudaEventSynchronize(event_));
+      }
+    }
+
+  private:
+    cudaEvent_t event_ = nullptr;
+  };
+
   class stream_view : public stream_interface::stream_view_base<cudaStream_t>
   {
   public:
@@ -288,6 +347,13 @@ public:
 
     void synchronize() { gtGpuCheck(cudaStreamSynchronize(this->stream_)); }
 
+    event record_event()
+    {
+      event e;
+      e.record(this->stream_);
+      return e;
+    }
+
     auto get_execution_policy() { return thrust::cuda::par.on(this->stream_); }
   };
 
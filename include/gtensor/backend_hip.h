@@ -310,6 +310,65 @@ public:
       hipMemcpyAsync(dst, src, sizeof(T) * count, hipMemcpyDeviceToDevice));
   }
 
+  // marks the work submitted to a stream up to when it was recorded; the
+  // handle is only created when first recorded, so default constructing an
+  // event is cheap, and an event never recorded counts as completed
+  class event
+  {
+  public:
+    event() = default;
+
+    ~event()
+    {
+      if (event_) {
+        gtGpuCheck(hipEventDestroy(event_));
+      }
+    }
+
+    event(const event&) = delete;
+    event& operator=(const event&) = delete;
+
+    event(event&& other) : event_(other.event_) { other.event_ = nullptr; }
+
+    event& operator=(event&& other)
+    {
+      std::swap(event_, other.event_);
+      return *this;
+    }
+
+    void record(hipStream_t stream)
+    {
+      if (!event_) {
+        gtGpuCheck(hipEventCreateWithFlags(&event_, hipEventDisableTiming));
+      }
+      gtGpuCheck(hipEventRecord(event_, stream));
+    }
+
+    // true if the marked work has completed
+    bool query() const
+    {
+      if (!event_) {
+        return true;
+      }
+      auto err = hipEventQuery(event_);
+      if (err == hipErrorNotReady) {
+        return false;
+      }
+      gtGpuCheck(err);
+      return true;
+    }
+
+    void synchronize() const
+    {
+      if (event_) {
+        gtGpuCheck(hipEventSynchronize(event_));
+      }
+    }
+
+  private:
+    hipEvent_t event_ = nullptr;
+  };
+
   class stream_view : public stream_interface::stream_view_base<hipStream_t>
   {
   public:
@@ -322,6 +381,13 @@ public:
 
     void synchronize() { gtGpuCheck(hipStreamSynchronize(this->stream_)); }
 
+    event record_event()
+    {
+      event e;
+      e.record(this->stream_);
+      return e;
+    }
+
     auto get_execution_policy() { return thrust::hip::par.on(this->stream_); }
   };
 
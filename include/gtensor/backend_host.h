@@ -3,9 +3,14 @@
 #define GTENSOR_BACKEND_HOST_H
 
 #include "backend_common.h"
+#include "backend_host_parallel.h"
+#include "host_allocation.h"
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
 
 #include <sys/sysinfo.h>
 
@@ -21,7 +26,7 @@ template <>
 class backend_ops<gt::space::host>
 {
 public:
-  static void device_synchronize() {}
+  static void device_synchronize() { host::task_queue::wait_all(); }
 
   static int device_get_count() { return 1; }
 
@@ -51,8 +56,45 @@ public:
   static void prefetch_host(T* p, size_type n)
   {}
 
+  // the default stream has no queue, work submitted to it runs inline
   class hostStream_t
-  {};
+  {
+  public:
+    host::task_queue* queue = nullptr;
+  };
+
+  // marks the work submitted to a stream up to when it was recorded; on the
+  // default stream, the work submitted to all streams, like
+  // device_synchronize()
+  class event
+  {
+  public:
+    event() = default;
+    explicit event(std::vector<host::task_queue::ticket> tickets)
+      : tickets_(std::move(tickets))
+    {}
+
+    // true if the marked work has completed
+    bool query() const
+    {
+      for (auto& t : tickets_) {
+        if (!host::task_queue::reached(t)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void synchronize() const
+    {
+      for (auto& t : tickets_) {
+        host::task_queue::wait_for(t);
+      }
+    }
+
+  private:
+    std::vector<host::task_queue::ticket> tickets_;
+  };
 
   class stream_view : public stream_interface::stream_view_base<hostStream_t>
   {
@@ -62,9 +104,33 @@ public:
 
     stream_view() : base_type({}) {}
 
-    bool is_default() { return true; }
-
-    void synchronize() {}
+    bool is_default() { return stream_.queue == nullptr; }
+
+    void synchronize()
+    {
+      if (stream_.queue) {
+        stream_.queue->wait();
+      }
+    }
+
+    event record_event()
+    {
+      if (stream_.queue) {
+        return event({stream_.queue->get_ticket()});
+      }
+      return event(host::task_queue::get_all_tickets());
+    }
+
+    // run f after the work already submitted to this stream
+    template <typename F>
+    void submit(F&& f)
+    {
+      if (stream_.queue) {
+        stream_.queue->submit(std::forward<F>(f));
+      } else {
+        std::forward<F>(f)();
+      }
+    }
   };
 
   static void mem_info(size_t* free, size_t* total)
@@ -76,29 +142,71 @@ public:
   }
 };
 
+namespace host
+{
+
+// Tasks on host streams use memory through non-owning views, so host memory
+// is only freed, by calling free(p), once the work submitted so far to the
+// calling thread's deallocation stream has completed; until then it is kept
+// on a list that is checked on later allocations and frees. Defined in
+// device_backend.h.
+inline void stream_ordered_free(void* p, void (*free)(void*));
+
+// free the memory on that list whose work has completed
+inline void free_completed();
+
+} // namespace host
+
 namespace allocator_impl
 {
+#if defined(GTENSOR_USE_MEMORY_POOL) && !defined(GTENSOR_HAVE_DEVICE)
+
 template <>
 struct gallocator<gt::space::host_only>
+  : pool_gallocator<gt::space::host_only, gt::memory_pool::memory_type::host>
 {
+  using base_type =
+    pool_gallocator<gt::space::host_only, gt::memory_pool::memory_type::host>;
+
   template <typename T>
   static T* allocate(size_type n)
   {
-    return static_cast<T*>(malloc(sizeof(T) * n));
+    host::free_completed();
+    return base_type::allocate<T>(n);
   }
 
   template <typename T>
   static void deallocate(T* p)
   {
-    free(p);
+    host::stream_ordered_free(
+      p, [](void* q) { base_type::deallocate(static_cast<T*>(q)); });
   }
 };
 
-template <typename T>
-struct selector<T, gt::space::host_only>
+#else // GTENSOR_USE_MEMORY_POOL
+
+template <>
+struct gallocator<gt::space::host_only>
 {
-  using type = std::allocator<T>;
+  template <typename T>
+  static T* allocate(size_type n)
+  {
+    host::free_completed();
+    void* p = host::aligned_allocate(sizeof(T) * n);
+    if (p == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+  }
+
+  template <typename T>
+  static void deallocate(T* p)
+  {
+    host::stream_ordered_free(p, host::aligned_deallocate);
+  }
 };
+
+#endif // GTENSOR_USE_MEMORY_POOL
 } // namespace allocator_impl
 
 namespace copy_impl
@@ -111,17 +219,26 @@ inline void copy_n(gt::space::host tag_in, gt::space::host tag_out, InputPtr in,
   // the same object if compiling for host only, so in that case, we don't need
   // to actually copy anything
   if (in != out) {
-    std::copy_n(in, count, out);
+    host::parallel_for(count, HOST_ASSIGN_GRAIN,
+                       [&](size_type begin, size_type end) {
+                         std::copy(in + begin, in + end, out + begin);
+                       });
   }
 }
 } // namespace copy_impl
 
 namespace fill_impl
 {
+// Fills and copies are split over the workers the same way as host
+// assignments, so the pages of a new array are first touched, and on NUMA
+// systems placed, by the workers that later assign to them.
 template <typename Ptr, typename T>
 inline void fill(gt::space::host tag, Ptr first, Ptr last, const T& value)
 {
-  std::fill(first, last, value);
+  host::parallel_for(last - first, HOST_ASSIGN_GRAIN,
+                     [&](size_type begin, size_type end) {
+                       std::fill(first + begin, first + end, value);
+                     });
 }
 } // namespace fill_impl
 
@@ -138,18 +255,29 @@ using hostStream_t = gt::backend::backend_ops<gt::space::host>::hostStream_t;
 class stream
 {
 public:
-  stream() {}
+  using view_t = gt::backend::backend_ops<gt::space::host>::stream_view;
+
+  stream() : queue_(new gt::backend::host::task_queue) {}
+
+  auto get_backend_stream()
+  {
+    return gt::backend::stream_interface::hostStream_t{queue_.get()};
+  }
 
-  auto get_backend_stream() { return nullptr; }
+  bool is_default() { return queue_ == nullptr; }
 
-  bool is_default() { return true; }
+  auto get_view() { return view_t(get_backend_stream()); }
 
-  auto get_view()
+  void synchronize()
   {
-    return gt::backend::backend_ops<gt::space::host>::stream_view();
+    if (queue_) {
+      queue_->wait();
+    }
   }
 
-  void synchronize() {}
+private:
+  // destroying the queue waits for its pending tasks
+  std::unique_ptr<gt::backend::host::task_queue> queue_;
 };
 
 #endif
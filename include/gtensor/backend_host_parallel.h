@@ -0,0 +1,712 @@
+#ifndef GTENSOR_BACKEND_HOST_PARALLEL_H
+#define GTENSOR_BACKEND_HOST_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+#include <thread>
+#endif
+#if defined(GTENSOR_HOST_PARALLEL_OPENMP)
+#include <omp.h>
+#endif
+
+#include "defs.h"
+
+// ======================================================================
+// gt::backend::host
+//
+// Worker pool used by the parallel host kernels, and the task queues behind
+// host streams. The implementation is selected at configure time with
+// GTENSOR_HOST_PARALLEL:
+//
+// - none: everything runs on the calling thread (default)
+// - threads: persistent std::thread pool, one thread per stream
+// - openmp: OpenMP parallel regions, one thread per stream
+//
+// The number of workers defaults to the hardware concurrency, and can be
+// overridden with the GTENSOR_NUM_THREADS environment variable.
+
+namespace gt
+{
+
+// minimum number of elements per worker for the parallel host assign, also
+// used by host fills and copies so that they partition arrays the same way
+constexpr const size_type HOST_ASSIGN_GRAIN = 32 * 1024;
+
+// ======================================================================
+// launch_policy
+//
+// Controls how host launches distribute their iterations over the workers.
+// Device launches ignore it.
+//
+// - static_: one contiguous block per worker, each at least grain_size
+// - dynamic: chunks of grain_size handed out on demand
+// - guided: chunks handed out on demand, shrinking from remaining / (2 *
+//   workers) down to grain_size
+//
+// grain_size == 0 picks a default, num_threads == 0 uses all workers.
+
+enum class launch_schedule
+{
+  static_,
+  dynamic,
+  guided
+};
+
+struct launch_policy
+{
+  launch_schedule schedule = launch_schedule::static_;
+  size_type grain_size = 0;
+  int num_threads = 0;
+};
+
+namespace backend
+{
+namespace host
+{
+
+namespace detail
+{
+
+inline int default_num_threads()
+{
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+  const char* env = std::getenv("GTENSOR_NUM_THREADS");
+  if (env != nullptr && std::atoi(env) > 0) {
+    return std::atoi(env);
+  }
+#endif
+#if defined(GTENSOR_HOST_PARALLEL_THREADS)
+  int n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1;
+#elif defined(GTENSOR_HOST_PARALLEL_OPENMP)
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+// true while the current thread is executing parallel work; nested parallel
+// calls (e.g. an assign inside a launched kernel) then run serially
+inline bool& in_parallel_region()
+{
+  static thread_local bool flag = false;
+  return flag;
+}
+
+} // namespace detail
+
+#ifdef GTENSOR_HOST_PARALLEL_THREADS
+
+// ======================================================================
+// thread_pool
+//
+// Fixed size pool of worker threads. The calling thread takes part in the
+// work as worker 0, so a pool of size n owns n - 1 threads.
+
+class thread_pool
+{
+public:
+  explicit thread_pool(int nthreads)
+  {
+    for (int tid = 1; tid < nthreads; tid++) {
+      threads_.emplace_back([this, tid] { worker(tid); });
+    }
+  }
+
+  ~thread_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_start_.notify_all();
+    for (auto& t : threads_) {
+      t.join();
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  int size() const { return static_cast<int>(threads_.size()) + 1; }
+
+  // call f(tid) for tid in [0, nworkers) and wait for completion; nworkers
+  // must not exceed size(). Returns false without calling f if the pool is
+  // already busy with a job submitted from another thread (e.g. another
+  // stream), in which case the caller should do the work itself.
+  bool try_run(int nworkers, const std::function<void(int)>& f)
+  {
+    assert(nworkers <= size());
+    std::unique_lock<std::mutex> run_lock(run_mutex_, std::try_to_lock);
+    if (!run_lock.owns_lock()) {
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job_ = &f;
+      job_workers_ = nworkers;
+      pending_ = nworkers - 1;
+      generation_++;
+    }
+    cv_start_.notify_all();
+
+    f(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_done_.wait(lock, [this] { return pending_ == 0; });
+    job_ = nullptr;
+    return true;
+  }
+
+private:
+  void worker(int tid)
+  {
+    unsigned long seen = 0;
+    while (true) {
+      const std::function<void(int)>* job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+        if (tid >= job_workers_) {
+          continue;
+        }
+        job = job_;
+      }
+
+      (*job)(tid);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_--;
+      }
+      cv_done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex run_mutex_;
+  std::mutex mutex_;
+  std::condition_variable cv_start_;
+  std::condition_variable cv_done_;
+  const std::function<void(int)>* job_ = nullptr;
+  int job_workers_ = 0;
+  int pending_ = 0;
+  unsigned long generation_ = 0;
+  bool stop_ = false;
+};
+
+inline thread_pool& get_thread_pool()
+{
+  static thread_pool pool(detail::default_num_threads());
+  return pool;
+}
+
+#endif // GTENSOR_HOST_PARALLEL_THREADS
+
+inline int get_num_threads()
+{
+#ifdef GTENSOR_HOST_PARALLEL_THREADS
+  return get_thread_pool().size();
+#else
+  static int nthreads = detail::default_num_threads();
+  return nthreads;
+#endif
+}
+
+namespace detail
+{
+
+/*! Run f(tid) for tid in [0, nworkers) on the configured workers. The first
+ * exception thrown by any worker is rethrown on the calling thread once all
+ * workers are done.
+ */
+template <typename F>
+inline void run_workers(int nworkers, F&& f)
+{
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto guarded = [&](int tid) {
+    bool& flag = in_parallel_region();
+    bool was_parallel = flag;
+    flag = true;
+    try {
+      f(tid);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+    flag = was_parallel;
+  };
+
+#if defined(GTENSOR_HOST_PARALLEL_THREADS)
+  if (!get_thread_pool().try_run(nworkers, guarded)) {
+    for (int tid = 0; tid < nworkers; tid++) {
+      guarded(tid);
+    }
+  }
+#elif defined(GTENSOR_HOST_PARALLEL_OPENMP)
+#pragma omp parallel num_threads(nworkers)
+  {
+    // the runtime may hand out fewer threads than requested
+    for (int tid = omp_get_thread_num(); tid < nworkers;
+         tid += omp_get_num_threads()) {
+      guarded(tid);
+    }
+  }
+#else
+  for (int tid = 0; tid < nworkers; tid++) {
+    guarded(tid);
+  }
+#endif
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace detail
+
+namespace detail
+{
+
+template <typename F>
+inline void parallel_for_static(size_type n, size_type grain_size,
+                                int max_workers, F&& f)
+{
+  size_type max_chunks = n / grain_size;
+  int nworkers =
+    static_cast<int>(std::min<size_type>(max_workers, max_chunks));
+  if (nworkers <= 1 || in_parallel_region()) {
+    f(size_type(0), n);
+    return;
+  }
+
+  size_type chunk = gt::div_ceil(n, nworkers);
+  run_workers(nworkers, [&](int tid) {
+    size_type begin = tid * chunk;
+    size_type end = std::min(n, begin + chunk);
+    if (begin < end) {
+      f(begin, end);
+    }
+  });
+}
+
+template <typename F>
+inline void parallel_for_dynamic(size_type n, size_type grain_size,
+                                 int max_workers, bool guided, F&& f)
+{
+  size_type max_chunks = gt::div_ceil(n, grain_size);
+  int nworkers =
+    static_cast<int>(std::min<size_type>(max_workers, max_chunks));
+  if (nworkers <= 1 || in_parallel_region()) {
+    f(size_type(0), n);
+    return;
+  }
+
+  std::atomic<size_type> next{0};
+  run_workers(nworkers, [&](int) {
+    size_type begin = next.load();
+    while (begin < n) {
+      size_type chunk = grain_size;
+      if (guided) {
+        chunk = std::max(chunk, (n - begin) / (2 * nworkers));
+      }
+      if (next.compare_exchange_weak(begin, begin + chunk)) {
+        f(begin, std::min(n, begin + chunk));
+        begin = next.load();
+      }
+    }
+  });
+}
+
+} // namespace detail
+
+/*! Call f(begin, end) on disjoint subranges covering [0, n), using at most
+ * one contiguous subrange per worker. Workers are only added as long as each
+ * gets at least grain_size iterations, so small ranges run on the calling
+ * thread.
+ */
+template <typename F>
+inline void parallel_for(size_type n, size_type grain_size, F&& f)
+{
+  if (n == 0) {
+    return;
+  }
+  detail::parallel_for_static(n, std::max<size_type>(grain_size, 1),
+                              get_num_threads(), std::forward<F>(f));
+}
+
+/*! Call f(begin, end) on disjoint subranges covering [0, n), chunked
+ * according to policy. A zero grain_size in the policy is replaced by
+ * default_grain_size.
+ */
+template <typename F>
+inline void parallel_for(size_type n, const launch_policy& policy,
+                         size_type default_grain_size, F&& f)
+{
+  if (n == 0) {
+    return;
+  }
+  size_type grain_size =
+    policy.grain_size > 0 ? policy.grain_size : default_grain_size;
+  grain_size = std::max<size_type>(grain_size, 1);
+  int max_workers = get_num_threads();
+  if (policy.num_threads > 0) {
+    max_workers = std::min(max_workers, policy.num_threads);
+  }
+
+  switch (policy.schedule) {
+    case launch_schedule::dynamic:
+      detail::parallel_for_dynamic(n, grain_size, max_workers, false,
+                                   std::forward<F>(f));
+      break;
+    case launch_schedule::guided:
+      detail::parallel_for_dynamic(n, grain_size, max_workers, true,
+                                   std::forward<F>(f));
+      break;
+    default:
+      detail::parallel_for_static(n, grain_size, max_workers,
+                                  std::forward<F>(f));
+  }
+}
+
+// ======================================================================
+// task_queue
+//
+// FIFO of host tasks backing a gt::stream. With a parallel host backend each
+// queue owns a thread that runs its tasks in submission order, so work
+// submitted to different streams overlaps. Without one, tasks run on the
+// submitting thread. The first exception thrown by a task is rethrown by the
+// next wait().
+//
+// A ticket marks the tasks submitted to a queue so far, so that one can later
+// check for or wait for their completion without waiting for the whole queue.
+//
+// A task that waits on its own queue, e.g. by calling gt::synchronize(), does
+// not wait for that queue: the tasks before it have completed already, and
+// the ones after it, or the task itself, cannot complete until it returns.
+
+class task_queue
+{
+public:
+  struct ticket
+  {
+    std::uint64_t queue_id;
+    std::uint64_t count;
+  };
+
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+  task_queue() : thread_([this] { worker(); }) { add(this); }
+
+  // runs the remaining tasks before the queue stops being waited on
+  ~task_queue()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_task_.notify_one();
+    thread_.join();
+    remove(this);
+  }
+
+  void submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+      if (completed_ == submitted_++) {
+        registry().busy++;
+      }
+    }
+    cv_task_.notify_one();
+  }
+
+  ticket get_ticket()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {id_, submitted_};
+  }
+#else
+  task_queue() { add(this); }
+
+  ~task_queue() { remove(this); }
+
+  void submit(std::function<void()> task) { run_task(task); }
+
+  // tasks run as they are submitted, so every ticket is already reached
+  ticket get_ticket() { return {id_, 0}; }
+#endif
+
+  task_queue(const task_queue&) = delete;
+  task_queue& operator=(const task_queue&) = delete;
+
+  // block until all submitted tasks have completed
+  void wait()
+  {
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+      if (current() != this) {
+        cv_idle_.wait(lock, [this] { return completed_ == submitted_; });
+      }
+#endif
+      std::swap(error, error_);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // wait on every live queue, as gt::synchronize() does for device streams
+  static void wait_all()
+  {
+    queue_refs queues([](const task_queue*) { return true; });
+    for (auto q : queues) {
+      q->wait();
+    }
+  }
+
+  // tickets for the tasks submitted so far to every live queue that still
+  // has some to run
+  static std::vector<ticket> get_all_tickets()
+  {
+    std::vector<ticket> tickets;
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+    if (!any_busy()) {
+      return tickets;
+    }
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto q : r.queues) {
+      std::lock_guard<std::mutex> qlock(q->mutex_);
+      if (q->completed_ < q->submitted_) {
+        tickets.push_back({q->id_, q->submitted_});
+      }
+    }
+#endif
+    return tickets;
+  }
+
+  // false if no queue has work in flight, checked without locking
+  static bool any_busy()
+  {
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+    return registry().busy.load() > 0;
+#else
+    return false;
+#endif
+  }
+
+  // true once the tasks marked by t have completed, or their queue is gone
+  static bool reached(const ticket& t)
+  {
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto q : r.queues) {
+      if (q->id_ == t.queue_id) {
+        std::lock_guard<std::mutex> qlock(q->mutex_);
+        return q->completed_ >= t.count;
+      }
+    }
+#endif
+    return true;
+  }
+
+  // block until the tasks marked by t have completed
+  static void wait_for(const ticket& t)
+  {
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+    queue_refs queues([&](const task_queue* q) {
+      return q->id_ == t.queue_id && q != current();
+    });
+    for (auto q : queues) {
+      std::unique_lock<std::mutex> qlock(q->mutex_);
+      q->cv_idle_.wait(qlock, [&] { return q->completed_ >= t.count; });
+    }
+#endif
+  }
+
+private:
+  struct queue_registry
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<task_queue*> queues;
+    // number of queues with tasks submitted but not completed
+    std::atomic<int> busy{0};
+  };
+
+  // The live queues selected by pred, which are not destroyed while this
+  // holds them, so that they can be waited on without holding the registry
+  // lock. Tasks may themselves create streams or record events, which needs
+  // that lock.
+  class queue_refs
+  {
+  public:
+    template <typename Pred>
+    explicit queue_refs(Pred pred)
+    {
+      auto& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      for (auto q : r.queues) {
+        if (pred(q)) {
+          q->refs_++;
+          queues_.push_back(q);
+        }
+      }
+    }
+
+    ~queue_refs()
+    {
+      auto& r = registry();
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (auto q : queues_) {
+          q->refs_--;
+        }
+      }
+      r.cv.notify_all();
+    }
+
+    queue_refs(const queue_refs&) = delete;
+    queue_refs& operator=(const queue_refs&) = delete;
+
+    using const_iterator = std::vector<task_queue*>::const_iterator;
+
+    const_iterator begin() const { return queues_.begin(); }
+    const_iterator end() const { return queues_.end(); }
+
+  private:
+    std::vector<task_queue*> queues_;
+  };
+
+  // the queue whose task the calling thread is running, if any
+  static task_queue*& current()
+  {
+    static thread_local task_queue* queue = nullptr;
+    return queue;
+  }
+
+  static queue_registry& registry()
+  {
+    static queue_registry r;
+    return r;
+  }
+
+  static void add(task_queue* q)
+  {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.queues.push_back(q);
+  }
+
+  // waits until no queue_refs holds q
+  static void remove(task_queue* q)
+  {
+    auto& r = registry();
+    std::unique_lock<std::mutex> lock(r.mutex);
+    r.cv.wait(lock, [q] { return q->refs_ == 0; });
+    r.queues.erase(std::remove(r.queues.begin(), r.queues.end(), q),
+                   r.queues.end());
+  }
+
+  void run_task(std::function<void()>& task)
+  {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+
+  static std::uint64_t next_id()
+  {
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+  }
+
+  std::mutex mutex_;
+  std::exception_ptr error_;
+  const std::uint64_t id_ = next_id();
+  // number of queue_refs holding this queue, guarded by the registry mutex
+  int refs_ = 0;
+
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+  void worker()
+  {
+    current() = this;
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_task_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+
+      run_task(task);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (++completed_ == submitted_) {
+          registry().busy--;
+        }
+      }
+      cv_idle_.notify_all();
+    }
+  }
+
+  std::condition_variable cv_task_;
+  std::condition_variable cv_idle_;
+  std::deque<std::function<void()>> tasks_;
+  // number of tasks submitted and completed so far
+  std::uint64_t submitted_ = 0;
+  std::uint64_t completed_ = 0;
+  bool stop_ = false;
+  // started last, once the members it uses are initialized
+  std::thread thread_;
+#endif
+};
+
+} // namespace host
+} // namespace backend
+} // namespace gt
+
+#endif // GTENSOR_BACKEND_HOST_PARALLEL_H
@@ -297,6 +297,27 @@ public:
     q.memcpy(dst, src, sizeof(T) * count);
   }
 
+  // marks the work submitted to a queue up to when it was recorded
+  class event
+  {
+  public:
+    event() = default;
+    explicit event(::sycl::event e) : event_(e) {}
+
+    // true if the marked work has completed
+    bool query() const
+    {
+      return event_
+               .get_info<::sycl::info::event::command_execution_status>() ==
+             ::sycl::info::event_command_status::complete;
+    }
+
+    void synchronize() const { event_.wait(); }
+
+  private:
+    mutable ::sycl::event event_;
+  };
+
   class stream_view : public stream_interface::stream_view_base<::sycl::queue&>
   {
   public:
@@ -319,6 +340,11 @@ public:
     }
 
     void synchronize() { stream_.wait(); }
+
+    event record_event()
+    {
+      return event(stream_.ext_oneapi_submit_barrier());
+    }
   };
 
   static void mem_info(size_t* free, size_t* total)
@@ -52,6 +52,35 @@ gt_backend_is_device_address(void* p);
 void gt_backend_prefetch_device(void* p, size_t nbytes);
 void gt_backend_prefetch_host(void* p, size_t nbytes);
 
+/**
+ * Allocation statistics, see gtensor/allocation_stats.h. Allocations made
+ * with the gt_backend_*_allocate functions above are included. For a space
+ * other than the GT_ALLOCATION_SPACE_* values, the statistics are all zero
+ * and resetting the peak does nothing.
+ */
+
+#define GT_ALLOCATION_SPACE_HOST 0
+#define GT_ALLOCATION_SPACE_HOST_PINNED 1
+#define GT_ALLOCATION_SPACE_DEVICE 2
+#define GT_ALLOCATION_SPACE_MANAGED 3
+
+#define GT_ALLOCATION_HISTOGRAM_BINS 64
+
+typedef struct gt_allocation_stats
+{
+  size_t live_bytes;
+  size_t peak_bytes;
+  size_t num_allocations;
+  size_t num_deallocations;
+  // histogram[k] counts allocations of [2^k, 2^(k + 1)) bytes
+  size_t histogram[GT_ALLOCATION_HISTOGRAM_BINS];
+} gt_allocation_stats;
+
+void gt_get_allocation_stats(int space, gt_allocation_stats* stats);
+void gt_get_tagged_allocation_stats(int space, const char* tag,
+                                    gt_allocation_stats* stats);
+void gt_reset_allocation_peak(int space);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,11 @@
 #ifndef GTENSOR_DEVICE_BACKEND_H
 #define GTENSOR_DEVICE_BACKEND_H
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "backend_host.h"
 #ifdef GTENSOR_DEVICE_CUDA
 #include "backend_cuda.h"
@@ -40,6 +45,193 @@ using clib = backend_ops<gt::space::host>;
 
 using stream_view = backend::clib::stream_view;
 
+using stream_event = backend::clib::event;
+
+// ======================================================================
+// deallocation_stream
+//
+// Work in flight may still use memory when it is freed, so the caching
+// allocator only reuses a freed block, and host memory is only released, once
+// the work submitted before the free to the freeing thread's deallocation
+// stream has completed. That is the default stream, unless a
+// deallocation_stream sets another one for its lifetime. Which work the
+// default stream orders a free after depends on the backend:
+//
+// - host: the work submitted to every gt::stream
+// - CUDA and HIP: the work submitted to every gt::stream, since those are
+//   blocking streams, which the legacy default stream waits for
+// - SYCL: only the work submitted to the default queue
+//
+// Memory used by work on another stream is therefore best freed while a
+// deallocation_stream for that stream is alive, e.g.
+//
+//   {
+//     gt::deallocation_stream ds(stream.get_view());
+//     auto tmp = gt::eval(a + b);
+//     gt::assign(c, tmp, stream.get_view());
+//   } // tmp becomes reusable once the assign on stream has completed
+
+class deallocation_stream
+{
+public:
+  explicit deallocation_stream(gt::stream_view stream)
+    : stream_(stream), prev_(current())
+  {
+    current() = &stream_;
+  }
+
+  ~deallocation_stream() { current() = prev_; }
+
+  deallocation_stream(const deallocation_stream&) = delete;
+  deallocation_stream& operator=(const deallocation_stream&) = delete;
+
+  // the calling thread's deallocation stream
+  static gt::stream_view get()
+  {
+    gt::stream_view* stream = current();
+    return stream ? *stream : gt::stream_view{};
+  }
+
+private:
+  static gt::stream_view*& current()
+  {
+    static thread_local gt::stream_view* stream = nullptr;
+    return stream;
+  }
+
+  gt::stream_view stream_;
+  gt::stream_view* prev_;
+};
+
+namespace backend
+{
+namespace host
+{
+
+#ifndef GTENSOR_HAVE_DEVICE
+
+namespace detail
+{
+
+struct deferred_free
+{
+  void* p;
+  void (*free)(void*);
+  gt::stream_event event;
+};
+
+struct deferred_free_list
+{
+  std::mutex mutex;
+  std::vector<deferred_free> entries;
+  std::atomic<std::size_t> size{0};
+};
+
+// never destroyed, memory may still be freed during static destruction
+inline deferred_free_list& get_deferred_free_list()
+{
+  static deferred_free_list* list = new deferred_free_list;
+  return *list;
+}
+
+// with list.mutex held
+inline void free_completed_locked(deferred_free_list& list)
+{
+  auto& entries = list.entries;
+  auto it = std::remove_if(entries.begin(), entries.end(),
+                           [](const deferred_free& d) {
+                             if (d.event.query()) {
+                               d.free(d.p);
+                               return true;
+                             }
+                             return false;
+                           });
+  entries.erase(it, entries.end());
+  list.size = entries.size();
+}
+
+} // namespace detail
+
+// skipped if another thread is already at it
+inline void free_completed()
+{
+  auto& list = detail::get_deferred_free_list();
+  if (list.size == 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(list.mutex, std::try_to_lock);
+  if (lock) {
+    detail::free_completed_locked(list);
+  }
+}
+
+inline void stream_ordered_free(void* p, void (*free)(void*))
+{
+  // with no host work in flight, there is no event worth recording
+  if (!task_queue::any_busy()) {
+    free(p);
+    free_completed();
+    return;
+  }
+  auto event = gt::deallocation_stream::get().record_event();
+  if (event.query()) {
+    free(p);
+    free_completed();
+    return;
+  }
+  auto& list = detail::get_deferred_free_list();
+  std::lock_guard<std::mutex> lock(list.mutex);
+  list.entries.push_back({p, free, std::move(event)});
+  list.size = list.entries.size();
+}
+
+#else
+
+// host work runs inline in device builds
+inline void free_completed() {}
+
+inline void stream_ordered_free(void* p, void (*free)(void*)) { free(p); }
+
+#endif
+
+} // namespace host
+} // namespace backend
+
+namespace detail
+{
+
+// Host work submitted with a stream is queued on that stream in host-only
+// builds. With a device backend the stream belongs to the device, and host
+// work runs inline.
+inline bool is_async_host_stream(gt::stream_view stream)
+{
+#ifdef GTENSOR_HAVE_DEVICE
+  return false;
+#else
+  return !stream.is_default();
+#endif
+}
+
+template <typename F>
+inline void host_stream_submit(gt::stream_view stream, F&& f)
+{
+#ifdef GTENSOR_HAVE_DEVICE
+  std::forward<F>(f)();
+#else
+  stream.submit(std::forward<F>(f));
+#endif
+}
+
+// wait for host work queued on stream, e.g. before reading its results
+inline void host_stream_wait(gt::stream_view stream)
+{
+#ifndef GTENSOR_HAVE_DEVICE
+  stream.synchronize();
+#endif
+}
+
+} // namespace detail
+
 template <typename T, typename S = gt::space::device>
 using device_allocator = typename backend::allocator_impl::selector<T, S>::type;
 
@@ -80,6 +272,29 @@ inline void copy_n(InputPtr in, gt::size_type count, OutputPtr out)
     typename pointer_traits<OutputPtr>::space_type{}, in, count, out);
 }
 
+// Host to host copies are queued on stream in host-only builds, all other
+// copies complete before returning.
+template <
+  typename InputPtr, typename OutputPtr,
+  std::enable_if_t<is_allowed_element_type_conversion<
+                     typename pointer_traits<OutputPtr>::element_type,
+                     typename pointer_traits<InputPtr>::element_type>::value,
+                   int> = 0>
+inline void copy_n(InputPtr in, gt::size_type count, OutputPtr out,
+                   gt::stream_view stream)
+{
+  using space_in = typename pointer_traits<InputPtr>::space_type;
+  using space_out = typename pointer_traits<OutputPtr>::space_type;
+  if (std::is_same<space_in, gt::space::host>::value &&
+      std::is_same<space_out, gt::space::host>::value &&
+      detail::is_async_host_stream(stream)) {
+    detail::host_stream_submit(
+      stream, [in, count, out] { gt::copy_n(in, count, out); });
+  } else {
+    gt::copy_n(in, count, out);
+  }
+}
+
 // ======================================================================
 // synchronize
 
@@ -116,7 +116,11 @@ inline void gcontainer<D>::resize(const shape_type& shape)
 {
   this->shape_ = shape;
   this->strides_ = calc_strides(shape);
-  storage().resize(calc_size(shape));
+  // a reshape keeping the number of elements leaves the storage alone
+  size_type size = calc_size(shape);
+  if (size != storage().size()) {
+    storage().resize(size);
+  }
 }
 
 #pragma nv_exec_check_disable
@@ -172,6 +172,12 @@ struct gt_empty_expr
 template <typename F, typename E1, typename E2>
 class gfunction;
 
+namespace detail
+{
+template <typename E, typename Enable>
+struct host_strided_evaluator;
+} // namespace detail
+
 template <typename F, typename E1, typename E2>
 struct gtensor_inner_types<gfunction<F, E1, E2>>
 {
@@ -245,6 +251,9 @@ public:
 private:
   F f_;
   E e_;
+
+  template <typename U, typename Enable>
+  friend struct detail::host_strided_evaluator;
 };
 
 template <typename F, typename E1, typename E2>
@@ -299,6 +308,9 @@ private:
   F f_;
   E1 e1_;
   E2 e2_;
+
+  template <typename U, typename Enable>
+  friend struct detail::host_strided_evaluator;
 };
 
 // ----------------------------------------------------------------------
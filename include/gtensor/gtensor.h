@@ -17,7 +17,9 @@
 #include "gview.h"
 #include "helper.h"
 #include "operator.h"
+#include "scratch.h"
 #include "space.h"
+#include "stensor.h"
 
 namespace gt
 {
@@ -67,6 +69,7 @@ public:
   using base_type::base_type;
   gtensor_container() = default;
   explicit gtensor_container(const shape_type& shape);
+  gtensor_container(const shape_type& shape, storage_type&& storage);
   gtensor_container(helper::nd_initializer_list_t<value_type, N> il);
   template <typename E>
   gtensor_container(const expression<E>& e);
@@ -110,6 +113,14 @@ inline gtensor_container<T, N>::gtensor_container(const shape_type& shape)
 #endif
 }
 
+template <typename T, size_type N>
+inline gtensor_container<T, N>::gtensor_container(const shape_type& shape,
+                                                  storage_type&& storage)
+  : base_type(shape, calc_strides(shape)), storage_(std::move(storage))
+{
+  assert(storage_.size() == calc_size(shape));
+}
+
 template <typename T, size_type N>
 template <typename E, typename Enabled>
 inline gtensor_container<T, N>::gtensor_container(const shape_type& shape,
@@ -316,105 +327,85 @@ namespace detail
 template <int N, typename Sp>
 struct launch;
 
-template <>
-struct launch<1, space::host>
+// minimum number of iterations per worker for host launches with the default
+// policy
+constexpr const size_type HOST_LAUNCH_GRAIN = 1024;
+
+// nested loops over the index box [lo, hi), innermost dimension first
+template <int D>
+struct host_launch_loop
 {
-  template <typename F>
-  static void run(const gt::shape_type<1>& shape, F&& f, gt::stream_view stream)
+  template <typename F, typename S>
+  static void run(F& f, S& idx, const S& lo, const S& hi)
   {
-    for (int i = 0; i < shape[0]; i++) {
-      std::forward<F>(f)(i);
+    for (idx[D - 1] = lo[D - 1]; idx[D - 1] < hi[D - 1]; idx[D - 1]++) {
+      host_launch_loop<D - 1>::run(f, idx, lo, hi);
     }
   }
 };
 
 template <>
-struct launch<2, space::host>
+struct host_launch_loop<0>
 {
-  template <typename F>
-  static void run(const gt::shape_type<2>& shape, F&& f, gt::stream_view stream)
+  template <typename F, typename S>
+  static void run(F& f, S& idx, const S&, const S&)
   {
-    for (int j = 0; j < shape[1]; j++) {
-      for (int i = 0; i < shape[0]; i++) {
-        std::forward<F>(f)(i, j);
-      }
-    }
+    index_expression(f, idx);
   }
 };
 
-template <>
-struct launch<3, space::host>
+// Host launches split the outermost dimension with extent > 1 across the
+// host workers, chunked according to the launch policy. The policy grain size
+// counts calls to f, and is rounded up to whole slices of that dimension.
+template <int N>
+struct launch<N, space::host>
 {
   template <typename F>
-  static void run(const gt::shape_type<3>& shape, F&& f, gt::stream_view stream)
+  static void run(const gt::shape_type<N>& shape, F&& f, gt::stream_view stream,
+                  const launch_policy& policy = launch_policy{})
   {
-    for (int k = 0; k < shape[2]; k++) {
-      for (int j = 0; j < shape[1]; j++) {
-        for (int i = 0; i < shape[0]; i++) {
-          std::forward<F>(f)(i, j, k);
-        }
-      }
+    if (gt::detail::is_async_host_stream(stream)) {
+      gt::detail::host_stream_submit(
+        stream, [shape, f = std::decay_t<F>(std::forward<F>(f)),
+                 policy]() mutable { run_now(shape, f, policy); });
+    } else {
+      run_now(shape, f, policy);
     }
   }
-};
 
-template <>
-struct launch<4, space::host>
-{
+private:
   template <typename F>
-  static void run(const gt::shape_type<4>& shape, F&& f, gt::stream_view stream)
+  static void run_now(const gt::shape_type<N>& shape, F& f,
+                      const launch_policy& policy)
   {
-    for (int l = 0; l < shape[3]; l++) {
-      for (int k = 0; k < shape[2]; k++) {
-        for (int j = 0; j < shape[1]; j++) {
-          for (int i = 0; i < shape[0]; i++) {
-            std::forward<F>(f)(i, j, k, l);
-          }
-        }
-      }
+    using shape_type = gt::shape_type<N>;
+    const size_type size = calc_size(shape);
+    if (size == 0) {
+      return;
     }
-  }
-};
 
-template <>
-struct launch<5, space::host>
-{
-  template <typename F>
-  static void run(const gt::shape_type<5>& shape, F&& f, gt::stream_view stream)
-  {
-    for (int m = 0; m < shape[4]; m++) {
-      for (int l = 0; l < shape[3]; l++) {
-        for (int k = 0; k < shape[2]; k++) {
-          for (int j = 0; j < shape[1]; j++) {
-            for (int i = 0; i < shape[0]; i++) {
-              std::forward<F>(f)(i, j, k, l, m);
-            }
-          }
-        }
-      }
+    int d = N - 1;
+    while (d > 0 && shape[d] == 1) {
+      d--;
     }
-  }
-};
+    const size_type slice_size = size / shape[d];
 
-template <>
-struct launch<6, space::host>
-{
-  template <typename F>
-  static void run(const gt::shape_type<6>& shape, F&& f, gt::stream_view stream)
-  {
-    for (int n = 0; n < shape[5]; n++) {
-      for (int m = 0; m < shape[4]; m++) {
-        for (int l = 0; l < shape[3]; l++) {
-          for (int k = 0; k < shape[2]; k++) {
-            for (int j = 0; j < shape[1]; j++) {
-              for (int i = 0; i < shape[0]; i++) {
-                std::forward<F>(f)(i, j, k, l, m, n);
-              }
-            }
-          }
-        }
-      }
+    launch_policy slice_policy = policy;
+    if (policy.grain_size > 0) {
+      slice_policy.grain_size = gt::div_ceil(policy.grain_size, slice_size);
     }
+    const size_type default_grain = gt::div_ceil(HOST_LAUNCH_GRAIN, slice_size);
+
+    gt::backend::host::parallel_for(
+      shape[d], slice_policy, default_grain,
+      [&](size_type begin, size_type end) {
+        shape_type idx;
+        shape_type lo;
+        shape_type hi = shape;
+        lo[d] = begin;
+        hi[d] = end;
+        host_launch_loop<N>::run(f, idx, lo, hi);
+      });
   }
 };
 
@@ -670,6 +661,52 @@ inline void launch(const gt::shape_type<N>& shape, F&& f,
   detail::launch<N, S>::run(shape, std::forward<F>(f), stream);
 }
 
+namespace detail
+{
+
+// the policy only affects host launches
+template <int N, typename S>
+struct launch_with_policy
+{
+  template <typename F>
+  static void run(const gt::shape_type<N>& shape, F&& f,
+                  const launch_policy& policy, gt::stream_view stream)
+  {
+    launch<N, S>::run(shape, std::forward<F>(f), stream);
+  }
+};
+
+template <int N>
+struct launch_with_policy<N, space::host>
+{
+  template <typename F>
+  static void run(const gt::shape_type<N>& shape, F&& f,
+                  const launch_policy& policy, gt::stream_view stream)
+  {
+    launch<N, space::host>::run(shape, std::forward<F>(f), stream, policy);
+  }
+};
+
+} // namespace detail
+
+template <int N, typename F>
+inline void launch_host(const gt::shape_type<N>& shape, F&& f,
+                        const launch_policy& policy,
+                        gt::stream_view stream = gt::stream_view{})
+{
+  detail::launch<N, space::host>::run(shape, std::forward<F>(f), stream,
+                                      policy);
+}
+
+template <int N, typename S, typename F>
+inline void launch(const gt::shape_type<N>& shape, F&& f,
+                   const launch_policy& policy,
+                   gt::stream_view stream = gt::stream_view{})
+{
+  detail::launch_with_policy<N, S>::run(shape, std::forward<F>(f), policy,
+                                       stream);
+}
+
 // ======================================================================
 // gtensor_device, gtensor_span_device
 
@@ -682,15 +719,19 @@ using gtensor_span_device = gtensor_span<T, N, space::device>;
 // ======================================================================
 // empty
 
+// within a gt::scratch_scope, the result comes from the scratch arena
+
 template <typename T, typename S = gt::space::host, size_type N>
 inline auto empty(const gt::shape_type<N> shape)
 {
+  detail::scratch_request scratch;
   return gtensor<T, N, S>(shape);
 }
 
 template <typename T, typename S = gt::space::host, size_type N>
 inline auto empty(const int (&shape)[N])
 {
+  detail::scratch_request scratch;
   return gtensor<T, N, S>(gt::shape_type<N>(shape));
 }
 
@@ -767,8 +808,8 @@ template <typename E>
 inline auto empty_like(const expression<E>& _e)
 {
   const auto& e = _e.derived();
-  return gtensor<expr_value_type<E>, expr_dimension<E>(), expr_space_type<E>>(
-    e.shape());
+  return gtensor<expr_value_type<E>, expr_dimension<E>(),
+                 expr_storage_space<E>>(e.shape());
 }
 
 // ======================================================================
@@ -780,8 +821,8 @@ template <typename E, typename T,
 inline auto full_like(const expression<E>& _e, T v)
 {
   const auto& e = _e.derived();
-  return gtensor<expr_value_type<E>, expr_dimension<E>(), expr_space_type<E>>(
-    e.shape(), v);
+  return gtensor<expr_value_type<E>, expr_dimension<E>(),
+                 expr_storage_space<E>>(e.shape(), v);
 }
 
 // ======================================================================
@@ -791,8 +832,8 @@ template <typename E>
 inline auto zeros_like(const expression<E>& _e)
 {
   const auto& e = _e.derived();
-  return gtensor<expr_value_type<E>, expr_dimension<E>(), expr_space_type<E>>(
-    e.shape(), 0);
+  return gtensor<expr_value_type<E>, expr_dimension<E>(),
+                 expr_storage_space<E>>(e.shape(), 0);
 }
 
 // ======================================================================
@@ -814,14 +855,18 @@ eval(E& e)
   return e;
 }
 
+// within a gt::scratch_scope, the result comes from the scratch arena
 template <typename E>
 inline std::enable_if_t<!is_gcontainer<E>::value ||
                           std::is_const<expr_value_type<E>>::value,
                         gtensor<std::remove_cv_t<expr_value_type<E>>,
-                                expr_dimension<E>(), expr_space_type<E>>>
+                                expr_dimension<E>(), expr_storage_space<E>>>
 eval(E&& e)
 {
-  return {std::forward<E>(e)};
+  auto result = gt::empty<std::remove_cv_t<expr_value_type<E>>,
+                          expr_storage_space<E>>(e.shape());
+  result = e;
+  return result;
 }
 
 // ======================================================================
@@ -847,6 +892,7 @@ std::enable_if_t<gt::has_data_and_size<SRC>::value &&
 copy(const SRC& src, DST&& dst)
 {
   if (!dst.is_f_contiguous()) {
+    detail::scratch_request scratch;
     auto dst_tmp = gt::empty_like(dst);
     gt::copy(src, dst_tmp);
     dst = dst_tmp;
@@ -887,6 +933,7 @@ std::enable_if_t<
   !gt::has_data_and_size<DST>::value>
 copy(const SRC& src, DST&& dst)
 {
+  detail::scratch_request scratch;
   auto dst_tmp = gt::empty_like(dst);
   gt::copy(src, dst_tmp);
   dst = dst_tmp;
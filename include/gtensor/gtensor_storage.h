@@ -5,10 +5,44 @@
 #include <type_traits>
 
 #include "device_backend.h"
+#include "scratch.h"
+
+// default factor by which gtensor_storage capacity grows when resized beyond
+// it; 1 allocates exactly the requested size
+#ifndef GTENSOR_STORAGE_GROWTH_FACTOR
+#define GTENSOR_STORAGE_GROWTH_FACTOR 1.0
+#endif
+
+// default fraction of its capacity below which resizing gtensor_storage
+// reallocates to the smaller size; 0 never gives memory back
+#ifndef GTENSOR_STORAGE_SHRINK_THRESHOLD
+#define GTENSOR_STORAGE_SHRINK_THRESHOLD 0.0
+#endif
 
 namespace gt
 {
 
+// ======================================================================
+// storage_policy
+//
+// How gtensor_storage::resize manages capacity. For arrays that are resized
+// often, e.g. as particle counts change,
+//
+//   a.storage().set_policy({1.5, 0.25});
+//
+// grows the capacity geometrically, so growing one element at a time
+// reallocates O(log n) times, and only reallocates to a smaller size when
+// less than a quarter of the capacity is used. The policy belongs to the
+// container: copies start out with it, and assigning to a container keeps it.
+
+struct storage_policy
+{
+  // on growth, capacity becomes at least this times the old capacity
+  double growth_factor = GTENSOR_STORAGE_GROWTH_FACTOR;
+  // shrink when the new size is below this fraction of the capacity
+  double shrink_threshold = GTENSOR_STORAGE_SHRINK_THRESHOLD;
+};
+
 namespace backend
 {
 
@@ -31,8 +65,10 @@ public:
 
   gtensor_storage(size_type count) : data_(), size_(count), capacity_(count)
   {
+    scratch_ = gt::detail::take_scratch_request();
     if (capacity_ > 0) {
-      data_ = allocator_.allocate(capacity_);
+      data_ = scratch_ ? gt::detail::scratch_allocate<T, A>(capacity_)
+                       : allocator_.allocate(capacity_);
     }
   }
   gtensor_storage() : gtensor_storage(0) {}
@@ -40,13 +76,13 @@ public:
   ~gtensor_storage()
   {
     if (capacity_ > 0) {
-      allocator_.deallocate(data_, capacity_);
+      deallocate_data(data_, capacity_);
     }
   }
 
   // copy and move constructors
   gtensor_storage(const gtensor_storage& dv)
-    : data_(nullptr), size_(0), capacity_(0)
+    : data_(nullptr), size_(0), capacity_(0), policy_(dv.policy_)
   {
     resize_discard(dv.size_);
 
@@ -56,8 +92,22 @@ public:
   }
 
   gtensor_storage(gtensor_storage&& dv)
-    : data_(dv.data_), size_(dv.size_), capacity_(dv.capacity_)
+    : data_(nullptr), size_(0), capacity_(0), policy_(dv.policy_)
   {
+    // scratch memory must not escape into a container that may outlive the
+    // scratch scope, so it is copied, and only copy elision keeps a scratch
+    // result in the arena
+    if (dv.scratch_) {
+      resize_discard(dv.size_);
+      if (size_ > 0) {
+        copy_n(dv.data_, size_, data_);
+      }
+      return;
+    }
+    data_ = dv.data_;
+    size_ = dv.size_;
+    capacity_ = dv.capacity_;
+
     dv.size_ = dv.capacity_ = 0;
     dv.data_ = {};
   }
@@ -79,12 +129,19 @@ public:
 
   gtensor_storage& operator=(gtensor_storage&& dv)
   {
+    // scratch memory must not escape into a container that may outlive the
+    // scratch scope
+    if (dv.scratch_) {
+      return *this = static_cast<const gtensor_storage&>(dv);
+    }
     if (capacity_ > 0) {
-      allocator_.deallocate(data_, capacity_);
+      deallocate_data(data_, capacity_);
     }
     data_ = dv.data_;
     size_ = dv.size_;
     capacity_ = dv.capacity_;
+    scratch_ = false;
+    // like copy assignment, keep this container's policy
 
     dv.size_ = dv.capacity_ = 0;
     dv.data_ = {};
@@ -95,6 +152,15 @@ public:
   // functions
   void resize(size_type new_size);
 
+  // make room for at least new_capacity elements without changing the size
+  void reserve(size_type new_capacity);
+
+  // reallocate so that the capacity equals the size
+  void shrink_to_fit();
+
+  const storage_policy& policy() const { return policy_; }
+  void set_policy(const storage_policy& policy) { policy_ = policy; }
+
   size_type size() const { return size_; }
   size_type capacity() const { return capacity_; }
   pointer data() { return data_; }
@@ -103,10 +169,23 @@ public:
 private:
   void resize(size_type new_size, bool discard);
   void resize_discard(size_type new_size);
+  void reallocate(size_type new_capacity, bool discard);
+
+  void deallocate_data(pointer p, size_type count)
+  {
+    if (scratch_) {
+      gt::detail::scratch_deallocate<T, A>(p, count);
+    } else {
+      allocator_.deallocate(p, count);
+    }
+  }
 
   pointer data_;
   size_type size_;
   size_type capacity_;
+  // data_ is in the scratch arena
+  bool scratch_ = false;
+  storage_policy policy_;
   allocator_type allocator_;
 };
 
@@ -119,29 +198,44 @@ using managed_storage = device_storage<T, gt::managed_allocator<T>>;
 template <typename T, typename A = gt::host_allocator<T>>
 using host_storage = gtensor_storage<T, A, space::host>;
 
+template <typename T, typename A, typename O>
+inline void gtensor_storage<T, A, O>::reallocate(
+  gtensor_storage::size_type new_capacity, bool discard)
+{
+  pointer new_data{};
+  if (new_capacity > 0) {
+    new_data = allocator_.allocate(new_capacity);
+    size_type copy_size = std::min(size_, new_capacity);
+    if (!discard && copy_size > 0) {
+      gt::copy_n(data_, copy_size, new_data);
+    }
+  }
+  if (capacity_ > 0) {
+    deallocate_data(data_, capacity_);
+  }
+  data_ = new_data;
+  capacity_ = new_capacity;
+  scratch_ = false;
+}
+
 template <typename T, typename A, typename O>
 inline void gtensor_storage<T, A, O>::resize(
   gtensor_storage::size_type new_size, bool discard)
 {
-  if (capacity_ == 0) {
-    if (new_size == 0) {
-      return;
-    }
-    capacity_ = size_ = new_size;
-    data_ = allocator_.allocate(capacity_);
-  } else if (new_size > capacity_) {
-    pointer new_data = allocator_.allocate(new_size);
-    if (!discard && size_ > 0) {
-      size_type copy_size = std::min(size_, new_size);
-      gt::copy_n(data_, copy_size, new_data);
+  if (new_size == size_) {
+    return;
+  }
+  if (new_size > capacity_) {
+    size_type new_capacity = new_size;
+    if (capacity_ > 0) {
+      new_capacity = std::max(
+        new_capacity, size_type(capacity_ * policy_.growth_factor));
     }
-    allocator_.deallocate(data_, capacity_);
-    data_ = new_data;
-    capacity_ = size_ = new_size;
-  } else {
-    // TODO: set reallocate shrink threshold?
-    size_ = new_size;
+    reallocate(new_capacity, discard);
+  } else if (new_size < capacity_ * policy_.shrink_threshold) {
+    reallocate(new_size, discard);
   }
+  size_ = new_size;
 }
 
 template <typename T, typename A, typename O>
@@ -158,6 +252,23 @@ inline void gtensor_storage<T, A, O>::resize(
   resize(new_size, false);
 }
 
+template <typename T, typename A, typename O>
+inline void gtensor_storage<T, A, O>::reserve(
+  gtensor_storage::size_type new_capacity)
+{
+  if (new_capacity > capacity_) {
+    reallocate(new_capacity, false);
+  }
+}
+
+template <typename T, typename A, typename O>
+inline void gtensor_storage<T, A, O>::shrink_to_fit()
+{
+  if (capacity_ > size_) {
+    reallocate(size_, false);
+  }
+}
+
 // ===================================================================
 // equality operators (for testing)
 
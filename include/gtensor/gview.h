@@ -158,6 +158,22 @@ using select_reshape_gview_adaptor_t =
 template <typename EC, size_type N>
 class gview;
 
+namespace detail
+{
+
+template <typename E>
+struct has_strided_data_access<
+  E, std::enable_if_t<is_gcontainer<E>::value || is_gtensor_span<E>::value>>
+  : std::true_type
+{};
+
+template <typename EC, size_type N>
+struct has_strided_data_access<gview<EC, N>>
+  : has_strided_data_access<std::decay_t<EC>>
+{};
+
+} // namespace detail
+
 template <typename EC, size_type N>
 struct gtensor_inner_types<gview<EC, N>>
 {
@@ -0,0 +1,112 @@
+#ifndef GTENSOR_HOST_ALLOCATION_H
+#define GTENSOR_HOST_ALLOCATION_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+#include <sys/mman.h>
+
+#include "defs.h"
+
+// alignment of every host allocation made by gtensor, at least a cache line
+// so SIMD kernels can use aligned loads
+#ifndef GTENSOR_HOST_ALIGNMENT
+#define GTENSOR_HOST_ALIGNMENT 64
+#endif
+
+// host allocations of at least this many bytes are aligned to huge pages and
+// advised to be backed by transparent huge pages; 0 turns this off
+#ifndef GTENSOR_HOST_HUGE_PAGE_THRESHOLD
+#define GTENSOR_HOST_HUGE_PAGE_THRESHOLD 0
+#endif
+
+namespace gt
+{
+
+// ======================================================================
+// host_alignment
+//
+// Guaranteed alignment in bytes of host gtensor storage, e.g.
+//
+//   if (gt::is_aligned(h.data())) { ... aligned loads ... }
+
+constexpr std::size_t host_alignment = GTENSOR_HOST_ALIGNMENT;
+
+static_assert(host_alignment >= sizeof(void*) &&
+                (host_alignment & (host_alignment - 1)) == 0,
+              "GTENSOR_HOST_ALIGNMENT must be a power of two multiple of "
+              "sizeof(void*)");
+
+template <typename T>
+inline bool is_aligned(const T* p, std::size_t alignment = host_alignment)
+{
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+namespace backend
+{
+namespace host
+{
+
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+namespace detail
+{
+
+inline std::atomic<std::size_t>& huge_page_threshold_value()
+{
+  static std::atomic<std::size_t> threshold{[] {
+    const char* env = std::getenv("GTENSOR_HOST_HUGE_PAGE_THRESHOLD");
+    return env != nullptr
+             ? std::size_t(std::strtoull(env, nullptr, 10))
+             : std::size_t(GTENSOR_HOST_HUGE_PAGE_THRESHOLD);
+  }()};
+  return threshold;
+}
+
+} // namespace detail
+
+// Size in bytes from which allocations use huge pages, 0 if never. Defaults
+// to GTENSOR_HOST_HUGE_PAGE_THRESHOLD, and can be overridden with the
+// environment variable of the same name.
+inline std::size_t huge_page_threshold()
+{
+  return detail::huge_page_threshold_value();
+}
+
+inline void set_huge_page_threshold(std::size_t nbytes)
+{
+  detail::huge_page_threshold_value() = nbytes;
+}
+
+// nullptr on failure; release with aligned_deallocate()
+inline void* aligned_allocate(std::size_t nbytes)
+{
+  std::size_t alignment = host_alignment;
+  std::size_t threshold = huge_page_threshold();
+  bool huge = threshold > 0 && nbytes >= threshold;
+  if (huge && alignment < HUGE_PAGE_SIZE) {
+    alignment = HUGE_PAGE_SIZE;
+  }
+  void* p = nullptr;
+  if (posix_memalign(&p, alignment, nbytes > 0 ? nbytes : 1) != 0) {
+    return nullptr;
+  }
+#ifdef MADV_HUGEPAGE
+  // only advise whole huge pages, the tail may be shared with other blocks
+  if (huge && nbytes >= HUGE_PAGE_SIZE) {
+    madvise(p, nbytes / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE, MADV_HUGEPAGE);
+  }
+#endif
+  return p;
+}
+
+inline void aligned_deallocate(void* p) { std::free(p); }
+
+} // namespace host
+} // namespace backend
+
+} // namespace gt
+
+#endif // GTENSOR_HOST_ALLOCATION_H
@@ -1,11 +1,239 @@
 #ifndef GTENSOR_MEMORY_POOL_H
 #define GTENSOR_MEMORY_POOL_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "gtensor/defs.h"
+#include "gtensor/host_allocation.h"
+
+// bytes requested from the upstream allocator the first time an arena needs
+// memory, and the most it will ever hold (0 means no limit)
+#ifndef GTENSOR_MEMORY_POOL_INITIAL_SIZE
+#define GTENSOR_MEMORY_POOL_INITIAL_SIZE (std::size_t(64) << 20)
+#endif
+
+#ifndef GTENSOR_MEMORY_POOL_MAX_SIZE
+#define GTENSOR_MEMORY_POOL_MAX_SIZE 0
+#endif
+
+namespace gt
+{
+namespace memory_pool
+{
+
+// ======================================================================
+// arena
+//
+// Coalescing best-fit pool carving blocks out of chunks obtained from an
+// upstream allocator. Each new chunk is at least as large as what the arena
+// already holds, so the number of upstream allocations grows only
+// logarithmically. Freed blocks are merged with free neighbors in the same
+// chunk, and chunks that become entirely free are only given back by
+// release(), or when growing would otherwise exceed the maximum size.
+
+class arena
+{
+public:
+  using upstream_allocate_type = void* (*)(std::size_t);
+  using upstream_deallocate_type = void (*)(void*);
+
+  // granularity of the blocks handed out, so blocks keep the alignment of
+  // the upstream chunks up to this
+  static constexpr size_type block_alignment =
+    gt::host_alignment > 256 ? gt::host_alignment : 256;
+
+  arena(upstream_allocate_type upstream_allocate,
+        upstream_deallocate_type upstream_deallocate,
+        size_type initial_size = GTENSOR_MEMORY_POOL_INITIAL_SIZE,
+        size_type max_size = GTENSOR_MEMORY_POOL_MAX_SIZE)
+    : upstream_allocate_{upstream_allocate},
+      upstream_deallocate_{upstream_deallocate},
+      initial_size_{initial_size},
+      max_size_{max_size}
+  {}
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  ~arena()
+  {
+    for (auto& chunk : chunks_) {
+      upstream_deallocate_(chunk.first);
+    }
+  }
+
+  // nullptr if the upstream allocator fails or the maximum size is reached
+  void* allocate(size_type nbytes)
+  {
+    nbytes = round_up(nbytes > 0 ? nbytes : 1);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_by_size_.lower_bound({nbytes, nullptr});
+    if (it == free_by_size_.end()) {
+      if (!grow(nbytes)) {
+        return nullptr;
+      }
+      it = free_by_size_.lower_bound({nbytes, nullptr});
+    }
+    char* p = it->second;
+    free_by_size_.erase(it);
+    auto blk = blocks_.find(p);
+    blk->second.free = false;
+    if (blk->second.size > nbytes) {
+      size_type rest = blk->second.size - nbytes;
+      blk->second.size = nbytes;
+      blocks_.emplace_hint(std::next(blk), p + nbytes,
+                           block{rest, true, false});
+      free_by_size_.emplace(rest, p + nbytes);
+    }
+    used_ += nbytes;
+    return p;
+  }
+
+  void deallocate(void* p)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto blk = blocks_.find(static_cast<char*>(p));
+    assert(blk != blocks_.end() && !blk->second.free);
+    used_ -= blk->second.size;
+    blk->second.free = true;
+
+    // merge with the following and preceding free blocks, unless they
+    // belong to another chunk
+    auto next = std::next(blk);
+    if (next != blocks_.end() && next->second.free &&
+        !next->second.chunk_start) {
+      free_by_size_.erase({next->second.size, next->first});
+      blk->second.size += next->second.size;
+      blocks_.erase(next);
+    }
+    if (!blk->second.chunk_start) {
+      auto prev = std::prev(blk);
+      if (prev->second.free) {
+        free_by_size_.erase({prev->second.size, prev->first});
+        prev->second.size += blk->second.size;
+        blocks_.erase(blk);
+        blk = prev;
+      }
+    }
+    free_by_size_.emplace(blk->second.size, blk->first);
+  }
+
+  // return chunks that are entirely free to the upstream allocator
+  void release()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    release_free_chunks();
+  }
+
+  // bytes currently held from the upstream allocator
+  size_type size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+  // bytes in blocks currently handed out
+  size_type used() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+  }
+
+  size_type max_size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_size_;
+  }
+
+  void set_max_size(size_type max_size)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_size_ = max_size;
+  }
+
+private:
+  struct block
+  {
+    size_type size;
+    bool free;
+    // first block in its chunk, so never merged with the preceding one
+    bool chunk_start;
+  };
+
+  static size_type round_up(size_type nbytes)
+  {
+    return (nbytes + block_alignment - 1) / block_alignment * block_alignment;
+  }
+
+  void release_free_chunks()
+  {
+    for (auto chunk = chunks_.begin(); chunk != chunks_.end();) {
+      auto blk = blocks_.find(chunk->first);
+      if (blk->second.free && blk->second.size == chunk->second) {
+        free_by_size_.erase({blk->second.size, blk->first});
+        blocks_.erase(blk);
+        upstream_deallocate_(chunk->first);
+        size_ -= chunk->second;
+        chunk = chunks_.erase(chunk);
+      } else {
+        ++chunk;
+      }
+    }
+  }
+
+  // add a chunk with room for at least nbytes
+  bool grow(size_type nbytes)
+  {
+    size_type chunk_size =
+      std::max(nbytes, std::max(round_up(initial_size_), size_));
+    if (max_size_ > 0) {
+      if (size_ + nbytes > max_size_) {
+        release_free_chunks();
+        if (size_ + nbytes > max_size_) {
+          return false;
+        }
+      }
+      chunk_size = std::max(nbytes, std::min(chunk_size, max_size_ - size_));
+    }
+    char* p = static_cast<char*>(upstream_allocate_(chunk_size));
+    if (p == nullptr) {
+      return false;
+    }
+    chunks_.emplace(p, chunk_size);
+    size_ += chunk_size;
+    blocks_.emplace(p, block{chunk_size, true, true});
+    free_by_size_.emplace(chunk_size, p);
+    return true;
+  }
+
+  upstream_allocate_type upstream_allocate_;
+  upstream_deallocate_type upstream_deallocate_;
+  size_type initial_size_;
+  size_type max_size_;
+  size_type size_ = 0;
+  size_type used_ = 0;
+  mutable std::mutex mutex_;
+  // chunk start -> size
+  std::map<char*, size_type> chunks_;
+  // all blocks, free or not, by address
+  std::map<char*, block> blocks_;
+  std::set<std::pair<size_type, char*>> free_by_size_;
+};
+
+} // namespace memory_pool
+} // namespace gt
+
 #ifdef GTENSOR_USE_MEMORY_POOL
 
 #ifdef GTENSOR_USE_RMM
-#include <map>
-
 #include <rmm/mr/device/cuda_memory_resource.hpp>
 #include <rmm/mr/device/managed_memory_resource.hpp>
 #include <rmm/mr/device/pool_memory_resource.hpp>
@@ -17,8 +245,6 @@
 #include <umpire/strategy/MixedPool.hpp>
 #endif
 
-#include "gtensor/defs.h"
-
 namespace gt
 {
 namespace memory_pool
@@ -28,7 +254,8 @@ enum class memory_type
 {
   device,
   managed,
-  host_pinned
+  host_pinned,
+  host
 };
 
 #if GTENSOR_USE_UMPIRE
@@ -219,7 +446,72 @@ inline void memory_pool::deallocate<memory_type::managed>(void* p)
 
 #else
 
-#error "No memory pool implementation specified"
+// built-in pool, for host builds without RMM or Umpire
+
+#ifdef GTENSOR_HAVE_DEVICE
+#error "The built-in memory pool supports host builds only, use RMM or Umpire"
+#endif
+
+class memory_pool
+{
+public:
+  memory_pool()
+    : host_{gt::backend::host::aligned_allocate,
+            gt::backend::host::aligned_deallocate},
+      host_pinned_{gt::backend::host::aligned_allocate,
+                   gt::backend::host::aligned_deallocate}
+  {}
+
+  template <memory_type MemType>
+  void* allocate(size_type nbytes);
+
+  template <memory_type MemType>
+  void deallocate(void* p);
+
+  template <memory_type MemType>
+  arena& get_arena();
+
+  // return memory not currently in use to the system
+  void release()
+  {
+    host_.release();
+    host_pinned_.release();
+  }
+
+private:
+  arena host_;
+  // without a device there is nothing to pin, but keep the pools separate
+  arena host_pinned_;
+};
+
+template <>
+inline arena& memory_pool::get_arena<memory_type::host>()
+{
+  return host_;
+}
+
+template <>
+inline arena& memory_pool::get_arena<memory_type::host_pinned>()
+{
+  return host_pinned_;
+}
+
+template <memory_type MemType>
+inline void* memory_pool::allocate(size_type nbytes)
+{
+  void* p = get_arena<MemType>().allocate(nbytes);
+  if (p == nullptr) {
+    throw std::runtime_error("host allocate failed");
+  }
+  return p;
+}
+
+template <memory_type MemType>
+inline void memory_pool::deallocate(void* p)
+{
+  assert(p != nullptr);
+  get_arena<MemType>().deallocate(p);
+}
 
 #endif
 
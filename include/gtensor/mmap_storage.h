@@ -0,0 +1,314 @@
+#ifndef GTENSOR_MMAP_STORAGE_H
+#define GTENSOR_MMAP_STORAGE_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gtensor.h"
+
+namespace gt
+{
+
+// ======================================================================
+// map_mode
+//
+// How gt::map_file maps a file:
+//
+// read_only:     the file is mapped read-only; writing to the array faults
+// copy_on_write: the array can be written to, but changes only affect this
+//                process's copy of the touched pages, the file is unchanged
+// shared_write:  changes are written back to the file, which is created or
+//                extended as needed
+
+enum class map_mode
+{
+  read_only,
+  copy_on_write,
+  shared_write
+};
+
+namespace backend
+{
+
+/*! A container implementing the 'storage' API for gtensor on top of mmap.
+ *
+ * Storage created with a size is an anonymous mapping, while map() maps
+ * (part of) a file, so that large tables can be used in place without first
+ * reading them into memory. Copies are anonymous mappings holding a copy of
+ * the data, and file mappings cannot be resized beyond their mapped size.
+ */
+template <typename T>
+class mmap_storage
+{
+public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using size_type = gt::size_type;
+  using space_type = gt::space::host;
+
+  static_assert(std::is_trivially_copyable<T>::value,
+                "mmap_storage requires a trivially copyable value type");
+
+  mmap_storage(size_type count) : size_(count), capacity_(count)
+  {
+    if (capacity_ > 0) {
+      map_anonymous();
+    }
+  }
+  mmap_storage() : mmap_storage(0) {}
+
+  ~mmap_storage() { unmap(); }
+
+  mmap_storage(const mmap_storage& other) : mmap_storage(other.size_)
+  {
+    copy_from(other);
+  }
+
+  mmap_storage(mmap_storage&& other) { swap(other); }
+
+  mmap_storage& operator=(const mmap_storage& other)
+  {
+    if (this != &other) {
+      if (is_file_mapping() && mode_ != map_mode::read_only &&
+          other.size_ <= capacity_) {
+        // assigning to a writable file mapping writes through it
+        size_ = other.size_;
+      } else {
+        mmap_storage tmp(other.size_);
+        swap(tmp);
+      }
+      copy_from(other);
+    }
+    return *this;
+  }
+
+  mmap_storage& operator=(mmap_storage&& other)
+  {
+    mmap_storage tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  // map count elements of type T starting at byte offset of the file at path;
+  // offset must be a multiple of alignof(T)
+  static mmap_storage map(const std::string& path, size_type count,
+                          map_mode mode = map_mode::read_only,
+                          std::size_t offset = 0);
+
+  void resize(size_type new_size)
+  {
+    if (new_size <= capacity_) {
+      size_ = new_size;
+      return;
+    }
+    if (is_file_mapping()) {
+      throw std::runtime_error(
+        "mmap_storage: cannot resize a file mapping beyond its mapped size");
+    }
+    mmap_storage tmp(new_size);
+    std::copy(data_, data_ + size_, tmp.data_);
+    swap(tmp);
+  }
+
+  // write changes to a shared_write file mapping back to the file
+  void flush()
+  {
+    if (is_file_mapping() && mode_ == map_mode::shared_write) {
+      if (msync(base_, length_, MS_SYNC) != 0) {
+        throw_errno("msync");
+      }
+    }
+  }
+
+  size_type size() const { return size_; }
+  size_type capacity() const { return capacity_; }
+  bool is_file_mapping() const { return file_; }
+  map_mode mode() const { return mode_; }
+
+  pointer data() { return data_; }
+  const_pointer data() const { return data_; }
+
+  reference operator[](size_type i) { return data_[i]; }
+  const_reference operator[](size_type i) const { return data_[i]; }
+
+  void swap(mmap_storage& other)
+  {
+    std::swap(base_, other.base_);
+    std::swap(length_, other.length_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(file_, other.file_);
+    std::swap(mode_, other.mode_);
+  }
+
+private:
+  [[noreturn]] static void throw_errno(const std::string& what,
+                                       const std::string& path = {})
+  {
+    std::string msg = "mmap_storage: " + what;
+    if (!path.empty()) {
+      msg += " '" + path + "'";
+    }
+    throw std::runtime_error(msg + ": " + std::strerror(errno));
+  }
+
+  void map_anonymous()
+  {
+    length_ = capacity_ * sizeof(T);
+    base_ = mmap(nullptr, length_, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base_ == MAP_FAILED) {
+      base_ = nullptr;
+      throw std::bad_alloc();
+    }
+    data_ = static_cast<pointer>(base_);
+  }
+
+  void unmap()
+  {
+    if (base_ != nullptr) {
+      munmap(base_, length_);
+      base_ = nullptr;
+    }
+  }
+
+  void copy_from(const mmap_storage& other)
+  {
+    std::copy(other.data_, other.data_ + other.size_, data_);
+  }
+
+  void* base_ = nullptr;
+  std::size_t length_ = 0;
+  pointer data_ = nullptr;
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+  bool file_ = false;
+  map_mode mode_ = map_mode::copy_on_write;
+};
+
+template <typename T>
+inline auto mmap_storage<T>::map(const std::string& path, size_type count,
+                                 map_mode mode, std::size_t offset)
+  -> mmap_storage
+{
+  if (offset % alignof(T) != 0) {
+    throw std::runtime_error("mmap_storage: offset " + std::to_string(offset) +
+                             " into '" + path + "' is not aligned to " +
+                             std::to_string(alignof(T)) + " bytes");
+  }
+  std::size_t nbytes = count * sizeof(T);
+  bool write = mode == map_mode::shared_write;
+
+  int fd = write ? open(path.c_str(), O_RDWR | O_CREAT, 0666)
+                 : open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw_errno("cannot open", path);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    throw_errno("cannot stat", path);
+  }
+  if (std::size_t(st.st_size) < offset + nbytes) {
+    if (!write) {
+      close(fd);
+      throw std::runtime_error("mmap_storage: '" + path + "' has " +
+                               std::to_string(st.st_size) + " bytes, need " +
+                               std::to_string(offset + nbytes));
+    }
+    if (ftruncate(fd, off_t(offset + nbytes)) != 0) {
+      int err = errno;
+      close(fd);
+      errno = err;
+      throw_errno("cannot extend", path);
+    }
+  }
+
+  mmap_storage s;
+  s.size_ = count;
+  s.capacity_ = count;
+  s.file_ = true;
+  s.mode_ = mode;
+  if (nbytes > 0) {
+    // mmap offsets must be page aligned
+    std::size_t page = std::size_t(sysconf(_SC_PAGESIZE));
+    std::size_t page_offset = offset % page;
+    int prot = mode == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+    int flags = mode == map_mode::copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+    s.length_ = page_offset + nbytes;
+    s.base_ =
+      mmap(nullptr, s.length_, prot, flags, fd, off_t(offset - page_offset));
+    if (s.base_ == MAP_FAILED) {
+      int err = errno;
+      s.base_ = nullptr;
+      close(fd);
+      errno = err;
+      throw_errno("cannot map", path);
+    }
+    s.data_ =
+      reinterpret_cast<pointer>(static_cast<char*>(s.base_) + page_offset);
+  }
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  return s;
+}
+
+} // namespace backend
+
+namespace space
+{
+
+template <typename T>
+struct storage_traits<gt::backend::mmap_storage<T>>
+{
+  using space_type = space::host;
+};
+
+} // namespace space
+
+// ======================================================================
+// map_file
+//
+// gtensor of shape `shape` whose elements are those of the file at `path`,
+// starting at byte `offset`, which must be a multiple of alignof(T), in
+// column-major order, e.g.
+//
+//   auto table = gt::map_file<double, 2>("table.bin", gt::shape(nx, ny));
+//
+// The file is mapped rather than read, so pages are only loaded as they are
+// accessed, and several processes mapping the same file share them. The
+// result is a host container that can be used like any other, e.g. in
+// expressions or through gt::adapt(table.data(), table.shape()).
+
+template <typename T, size_type N>
+using mmap_gtensor = gtensor_container<backend::mmap_storage<T>, N>;
+
+template <typename T, size_type N>
+inline mmap_gtensor<T, N> map_file(const std::string& path,
+                                   const gt::shape_type<N>& shape,
+                                   map_mode mode = map_mode::read_only,
+                                   std::size_t offset = 0)
+{
+  return mmap_gtensor<T, N>(
+    shape, backend::mmap_storage<T>::map(path, calc_size(shape), mode, offset));
+}
+
+} // namespace gt
+
+#endif // GTENSOR_MMAP_STORAGE_H
@@ -0,0 +1,849 @@
+#ifndef GTENSOR_NPY_H
+#define GTENSOR_NPY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gtensor.h"
+#include "mmap_storage.h"
+
+namespace gt
+{
+
+// ======================================================================
+// .npy / .npz files
+//
+// Arrays are saved in numpy's .npy format with fortran_order set, so that
+// the column-major gtensor data is written as is, and numpy sees the same
+// shape and indexing as gtensor:
+//
+//   gt::save_npy("phi.npy", phi);                       // np.load("phi.npy")
+//   auto phi = gt::load_npy<double, 6>("phi.npy");
+//   auto table = gt::load_npy_mmap<double, 3>("table.npy");
+//
+// .npz archives are uncompressed zip files holding one .npy file per array,
+// as written by np.savez:
+//
+//   gt::save_npz("fields.npz", "rho", rho, "phi", phi);
+//   gt::npz_reader npz("fields.npz");
+//   auto rho = npz.load<double, 3>("rho");
+//
+// Files in C order are transposed on load, except by the mmap variants,
+// which only accept Fortran order (or 1-d) data.
+
+namespace detail
+{
+
+constexpr bool npy_little_endian()
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return false;
+#else
+  return true;
+#endif
+}
+
+inline std::string npy_descr_str(char kind, std::size_t size)
+{
+  char order = size == 1 ? '|' : (npy_little_endian() ? '<' : '>');
+  return order + std::string(1, kind) + std::to_string(size);
+}
+
+template <typename T, typename Enable = void>
+struct npy_descr;
+
+template <>
+struct npy_descr<bool>
+{
+  static std::string get() { return "|b1"; }
+};
+
+template <typename T>
+struct npy_descr<T, std::enable_if_t<std::is_integral<T>::value &&
+                                     !std::is_same<T, bool>::value>>
+{
+  static std::string get()
+  {
+    return npy_descr_str(std::is_signed<T>::value ? 'i' : 'u', sizeof(T));
+  }
+};
+
+template <typename T>
+struct npy_descr<T, std::enable_if_t<std::is_floating_point<T>::value>>
+{
+  static std::string get() { return npy_descr_str('f', sizeof(T)); }
+};
+
+template <typename T>
+struct npy_descr<T, std::enable_if_t<gt::is_complex_v<T>>>
+{
+  static std::string get() { return npy_descr_str('c', sizeof(T)); }
+};
+
+struct npy_header
+{
+  std::string descr;
+  bool fortran_order;
+  std::vector<std::size_t> shape;
+  // offset of the array data from the start of the file
+  std::size_t data_offset;
+};
+
+[[noreturn]] inline void npy_error(const std::string& path,
+                                   const std::string& what)
+{
+  throw std::runtime_error("npy: '" + path + "': " + what);
+}
+
+// header for an array with given descr and shape, padded so that the data
+// starts at a multiple of 64 bytes
+inline std::string npy_make_header(const std::string& descr,
+                                   const std::vector<std::size_t>& shape)
+{
+  std::string dict =
+    "{'descr': '" + descr + "', 'fortran_order': True, 'shape': (";
+  for (std::size_t d = 0; d < shape.size(); d++) {
+    dict += std::to_string(shape[d]) + (d + 1 < shape.size() ? ", " : "");
+  }
+  // python spells a 1-tuple (n,)
+  dict += shape.size() == 1 ? ",), }" : "), }";
+
+  // version 1.0 has a 2-byte header length, 2.0 a 4-byte one
+  bool v1 = dict.size() + 1 + 10 + 64 <= 65535;
+  std::size_t prefix = v1 ? 10 : 12;
+  std::size_t total = (prefix + dict.size() + 1 + 63) / 64 * 64;
+  dict.append(total - prefix - dict.size() - 1, ' ');
+  dict += '\n';
+
+  std::string header("\x93NUMPY", 6);
+  header += char(v1 ? 1 : 2);
+  header += char(0);
+  std::size_t len = dict.size();
+  for (std::size_t i = 0; i < (v1 ? 2u : 4u); i++) {
+    header += char((len >> (8 * i)) & 0xff);
+  }
+  return header + dict;
+}
+
+// value of key in a header dict, up to the next top level ',' or '}'
+inline std::string npy_dict_value(const std::string& dict,
+                                  const std::string& key,
+                                  const std::string& path)
+{
+  auto pos = dict.find("'" + key + "'");
+  if (pos == std::string::npos) {
+    npy_error(path, "header has no '" + key + "'");
+  }
+  pos = dict.find(':', pos);
+  if (pos == std::string::npos) {
+    npy_error(path, "invalid header");
+  }
+  pos = dict.find_first_not_of(' ', pos + 1);
+  auto end = pos;
+  int depth = 0;
+  for (; end < dict.size(); end++) {
+    char c = dict[end];
+    if (c == '(') {
+      depth++;
+    } else if (c == ')') {
+      depth--;
+    } else if (depth == 0 && (c == ',' || c == '}')) {
+      break;
+    }
+  }
+  auto value = dict.substr(pos, end - pos);
+  return value.substr(0, value.find_last_not_of(' ') + 1);
+}
+
+inline npy_header npy_read_header(std::istream& f, std::size_t offset,
+                                  const std::string& path)
+{
+  f.seekg(offset);
+  char prefix[12];
+  if (!f.read(prefix, 10) || std::string(prefix, 6) != "\x93NUMPY") {
+    npy_error(path, "not a .npy file");
+  }
+  int major = prefix[6];
+  std::size_t len = std::uint8_t(prefix[8]) | (std::uint8_t(prefix[9]) << 8);
+  std::size_t prefix_len = 10;
+  if (major >= 2) {
+    if (!f.read(prefix + 10, 2)) {
+      npy_error(path, "truncated header");
+    }
+    len |= (std::size_t(std::uint8_t(prefix[10])) << 16) |
+           (std::size_t(std::uint8_t(prefix[11])) << 24);
+    prefix_len = 12;
+  }
+  std::string dict(len, '\0');
+  if (!f.read(&dict[0], len)) {
+    npy_error(path, "truncated header");
+  }
+
+  npy_header h;
+  h.data_offset = offset + prefix_len + len;
+  auto descr = npy_dict_value(dict, "descr", path);
+  if (descr.size() < 2 || (descr[0] != '\'' && descr[0] != '"')) {
+    npy_error(path, "unsupported descr " + descr);
+  }
+  h.descr = descr.substr(1, descr.size() - 2);
+  if (!h.descr.empty() && h.descr[0] == '=') {
+    h.descr = npy_descr_str(h.descr[1], std::atoi(h.descr.c_str() + 2));
+  }
+  h.fortran_order = npy_dict_value(dict, "fortran_order", path) == "True";
+  auto shape = npy_dict_value(dict, "shape", path);
+  for (std::size_t pos = 1; pos < shape.size();) {
+    auto end = shape.find_first_of(",)", pos);
+    auto dim = shape.substr(pos, end - pos);
+    if (dim.find_first_not_of(' ') != std::string::npos) {
+      h.shape.push_back(std::strtoull(dim.c_str(), nullptr, 10));
+    }
+    pos = end + 1;
+  }
+  return h;
+}
+
+template <typename T, size_type N>
+inline gt::shape_type<N> npy_check_header(const npy_header& h,
+                                          const std::string& path)
+{
+  if (h.descr != npy_descr<T>::get()) {
+    npy_error(path, "has dtype " + h.descr + ", expected " +
+                      npy_descr<T>::get());
+  }
+  if (h.shape.size() != N) {
+    npy_error(path, "has " + std::to_string(h.shape.size()) +
+                      " dimensions, expected " + std::to_string(N));
+  }
+  gt::shape_type<N> shape;
+  for (size_type d = 0; d < N; d++) {
+    shape[d] = int(h.shape[d]);
+  }
+  return shape;
+}
+
+template <typename T, size_type N>
+inline gt::gtensor<T, N> npy_load(const std::string& path, std::size_t offset)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    npy_error(path, "cannot open");
+  }
+  auto h = npy_read_header(f, offset, path);
+  auto shape = npy_check_header<T, N>(h, path);
+
+  gt::gtensor<T, N> a(shape);
+  auto nbytes = std::streamsize(a.size() * sizeof(T));
+  if (h.fortran_order || N <= 1) {
+    if (!f.read(reinterpret_cast<char*>(a.data()), nbytes)) {
+      npy_error(path, "truncated data");
+    }
+    return a;
+  }
+
+  // C order: element (i0, i1, ...) is at i0 * s0 + i1 * s1 + ...
+  std::vector<T> c_data(a.size());
+  if (!f.read(reinterpret_cast<char*>(c_data.data()), nbytes)) {
+    npy_error(path, "truncated data");
+  }
+  gt::shape_type<N> c_strides;
+  size_type stride = 1;
+  for (int d = int(N) - 1; d >= 0; d--) {
+    c_strides[d] = int(stride);
+    stride *= shape[d];
+  }
+  gt::shape_type<N> idx;
+  for (size_type d = 0; d < N; d++) {
+    idx[d] = 0;
+  }
+  size_type c_offset = 0;
+  for (size_type i = 0; i < a.size(); i++) {
+    a.data()[i] = c_data[c_offset];
+    for (size_type d = 0; d < N; d++) {
+      c_offset += c_strides[d];
+      if (++idx[d] < shape[d]) {
+        break;
+      }
+      c_offset -= size_type(idx[d]) * c_strides[d];
+      idx[d] = 0;
+    }
+  }
+  return a;
+}
+
+template <typename T, size_type N>
+inline gt::mmap_gtensor<T, N> npy_load_mmap(const std::string& path,
+                                            std::size_t offset, map_mode mode)
+{
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    npy_error(path, "cannot open");
+  }
+  auto h = npy_read_header(f, offset, path);
+  auto shape = npy_check_header<T, N>(h, path);
+  if (!h.fortran_order && N > 1) {
+    npy_error(path, "C order data cannot be mapped, use load_npy()");
+  }
+  // map_file checks that the data is aligned
+  return gt::map_file<T, N>(path, shape, mode, h.data_offset);
+}
+
+// contiguous host copy of e, or e itself if it already is one
+template <typename E, typename Enable = void>
+struct npy_host_data
+{
+  using value_type = std::remove_const_t<gt::expr_value_type<E>>;
+
+  npy_host_data(const E& e) : h(e.shape()) { gt::copy(e, h); }
+
+  const value_type* data() const { return h.data(); }
+
+  gt::gtensor<value_type, gt::expr_dimension<E>()> h;
+};
+
+template <typename E>
+struct npy_host_data<
+  E, std::enable_if_t<
+       std::is_same<gt::expr_space_type<E>, gt::space::host>::value &&
+       gt::has_data_and_size<E>::value>>
+{
+  using value_type = std::remove_const_t<gt::expr_value_type<E>>;
+
+  npy_host_data(const E& e) : e(e)
+  {
+    if (!e.is_f_contiguous()) {
+      h.resize(e.shape());
+      h = e;
+    }
+  }
+
+  const value_type* data() const
+  {
+    return e.is_f_contiguous() ? e.data() : h.data();
+  }
+
+  const E& e;
+  gt::gtensor<value_type, gt::expr_dimension<E>()> h;
+};
+
+template <typename E>
+inline std::vector<std::size_t> npy_shape(const E& e)
+{
+  std::vector<std::size_t> shape;
+  for (size_type d = 0; d < gt::expr_dimension<E>(); d++) {
+    shape.push_back(e.shape(d));
+  }
+  return shape;
+}
+
+// header and data of e as .npy
+template <typename E>
+struct npy_image
+{
+  using value_type = typename npy_host_data<E>::value_type;
+
+  npy_image(const E& e) : host(e)
+  {
+    header = npy_make_header(npy_descr<value_type>::get(), npy_shape(e));
+    data = reinterpret_cast<const char*>(host.data());
+    nbytes = e.size() * sizeof(value_type);
+  }
+
+  npy_host_data<E> host;
+  std::string header;
+  const char* data;
+  std::size_t nbytes;
+};
+
+// ----------------------------------------------------------------------
+// zip helpers
+
+inline std::uint32_t crc32(std::uint32_t crc, const char* data,
+                           std::size_t size)
+{
+  static const auto table = [] {
+    std::array<std::uint32_t, 256> t;
+    for (std::uint32_t i = 0; i < 256; i++) {
+      std::uint32_t c = i;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      t[i] = c;
+    }
+    return t;
+  }();
+  crc = ~crc;
+  for (std::size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ std::uint8_t(data[i])) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+template <typename U>
+inline void zip_put(std::string& s, U v)
+{
+  for (std::size_t i = 0; i < sizeof(U); i++) {
+    s += char((std::uint64_t(v) >> (8 * i)) & 0xff);
+  }
+}
+
+inline std::uint64_t zip_get(const char* p, int nbytes)
+{
+  std::uint64_t v = 0;
+  for (int i = nbytes - 1; i >= 0; i--) {
+    v = (v << 8) | std::uint8_t(p[i]);
+  }
+  return v;
+}
+
+constexpr std::uint64_t ZIP_MAX32 = 0xffffffffu;
+
+} // namespace detail
+
+// ======================================================================
+// save_npy / load_npy
+
+namespace detail
+{
+
+inline void npy_write_file(const std::string& path, const std::string& header,
+                           const char* data, std::size_t nbytes)
+{
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  if (!f) {
+    npy_error(path, "cannot open for writing");
+  }
+  // the data goes out in a single write straight from the array
+  f.write(header.data(), header.size());
+  f.write(data, nbytes);
+  if (!f.flush()) {
+    npy_error(path, "write failed");
+  }
+}
+
+} // namespace detail
+
+template <typename E>
+inline void save_npy(const std::string& path, const E& e)
+{
+  detail::npy_image<E> img(e);
+  detail::npy_write_file(path, img.header, img.data, img.nbytes);
+}
+
+template <typename T, size_type N>
+inline gt::gtensor<T, N> load_npy(const std::string& path)
+{
+  return detail::npy_load<T, N>(path, 0);
+}
+
+// load into an existing container or span of the same shape, in any space
+template <typename E>
+inline void load_npy(const std::string& path, E&& dst)
+{
+  using E_ = std::decay_t<E>;
+  auto h = load_npy<std::remove_const_t<gt::expr_value_type<E_>>,
+                    gt::expr_dimension<E_>()>(path);
+  if (h.shape() != dst.shape()) {
+    detail::npy_error(path, "shape does not match destination");
+  }
+  gt::copy(h, dst);
+}
+
+// map the file instead of reading it, see gt::map_file
+template <typename T, size_type N>
+inline gt::mmap_gtensor<T, N> load_npy_mmap(
+  const std::string& path, map_mode mode = map_mode::read_only)
+{
+  return detail::npy_load_mmap<T, N>(path, 0, mode);
+}
+
+// ======================================================================
+// npz_writer
+//
+// Writes arrays into an uncompressed .npz archive, which is finished when
+// close() is called or the writer is destroyed.
+
+class npz_writer
+{
+public:
+  explicit npz_writer(const std::string& path)
+    : path_(path), f_(path, std::ios::binary | std::ios::trunc)
+  {
+    if (!f_) {
+      detail::npy_error(path_, "cannot open for writing");
+    }
+  }
+
+  npz_writer(const npz_writer&) = delete;
+  npz_writer& operator=(const npz_writer&) = delete;
+
+  ~npz_writer()
+  {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  // adds e as "<name>.npy", which np.load gives back as npz[name]
+  template <typename E>
+  void add(const std::string& name, const E& e)
+  {
+    detail::npy_image<E> img(e);
+    entry ent;
+    ent.name = name + ".npy";
+    ent.offset = offset_;
+    ent.size = img.header.size() + img.nbytes;
+    ent.crc = detail::crc32(0, img.header.data(), img.header.size());
+    ent.crc = detail::crc32(ent.crc, img.data, img.nbytes);
+
+    bool zip64 = ent.size >= detail::ZIP_MAX32;
+    std::size_t zip64_len = zip64 ? 20 : 0;
+    // the npy header is a multiple of 64 bytes, so padding the local header
+    // to one as well aligns the data for load_mmap(); the padding is an extra
+    // field in the format zipalign uses (id, size, alignment, zeros)
+    std::size_t pad =
+      (64 - (offset_ + 30 + ent.name.size() + zip64_len) % 64) % 64;
+    if (pad != 0 && pad < 6) {
+      pad += 64;
+    }
+    std::string lh;
+    detail::zip_put<std::uint32_t>(lh, 0x04034b50);
+    detail::zip_put<std::uint16_t>(lh, zip64 ? 45 : 20);
+    detail::zip_put<std::uint16_t>(lh, 0);      // flags
+    detail::zip_put<std::uint16_t>(lh, 0);      // stored
+    detail::zip_put<std::uint16_t>(lh, 0);      // time
+    detail::zip_put<std::uint16_t>(lh, 0x21);   // date, 1980-01-01
+    detail::zip_put<std::uint32_t>(lh, ent.crc);
+    detail::zip_put<std::uint32_t>(lh, zip64 ? detail::ZIP_MAX32 : ent.size);
+    detail::zip_put<std::uint32_t>(lh, zip64 ? detail::ZIP_MAX32 : ent.size);
+    detail::zip_put<std::uint16_t>(lh, ent.name.size());
+    detail::zip_put<std::uint16_t>(lh, zip64_len + pad);
+    lh += ent.name;
+    if (zip64) {
+      detail::zip_put<std::uint16_t>(lh, 1);
+      detail::zip_put<std::uint16_t>(lh, 16);
+      detail::zip_put<std::uint64_t>(lh, ent.size);
+      detail::zip_put<std::uint64_t>(lh, ent.size);
+    }
+    if (pad != 0) {
+      detail::zip_put<std::uint16_t>(lh, 0xd935);
+      detail::zip_put<std::uint16_t>(lh, pad - 4);
+      detail::zip_put<std::uint16_t>(lh, 64);
+      lh.append(pad - 6, '\0');
+    }
+
+    f_.write(lh.data(), lh.size());
+    f_.write(img.header.data(), img.header.size());
+    f_.write(img.data, img.nbytes);
+    if (!f_) {
+      detail::npy_error(path_, "write failed");
+    }
+    offset_ += lh.size() + ent.size;
+    entries_.push_back(std::move(ent));
+  }
+
+  // writes the zip central directory
+  void close()
+  {
+    if (!f_.is_open()) {
+      return;
+    }
+    std::string cd;
+    for (const auto& ent : entries_) {
+      bool zip64 =
+        ent.size >= detail::ZIP_MAX32 || ent.offset >= detail::ZIP_MAX32;
+      detail::zip_put<std::uint32_t>(cd, 0x02014b50);
+      detail::zip_put<std::uint16_t>(cd, zip64 ? 45 : 20); // made by
+      detail::zip_put<std::uint16_t>(cd, zip64 ? 45 : 20); // needed
+      detail::zip_put<std::uint16_t>(cd, 0);
+      detail::zip_put<std::uint16_t>(cd, 0);
+      detail::zip_put<std::uint16_t>(cd, 0);
+      detail::zip_put<std::uint16_t>(cd, 0x21);
+      detail::zip_put<std::uint32_t>(cd, ent.crc);
+      detail::zip_put<std::uint32_t>(cd, zip64 ? detail::ZIP_MAX32 : ent.size);
+      detail::zip_put<std::uint32_t>(cd, zip64 ? detail::ZIP_MAX32 : ent.size);
+      detail::zip_put<std::uint16_t>(cd, ent.name.size());
+      detail::zip_put<std::uint16_t>(cd, zip64 ? 28 : 0);
+      detail::zip_put<std::uint16_t>(cd, 0); // comment
+      detail::zip_put<std::uint16_t>(cd, 0); // disk
+      detail::zip_put<std::uint16_t>(cd, 0); // internal attributes
+      detail::zip_put<std::uint32_t>(cd, 0); // external attributes
+      detail::zip_put<std::uint32_t>(cd,
+                                     zip64 ? detail::ZIP_MAX32 : ent.offset);
+      cd += ent.name;
+      if (zip64) {
+        detail::zip_put<std::uint16_t>(cd, 1);
+        detail::zip_put<std::uint16_t>(cd, 24);
+        detail::zip_put<std::uint64_t>(cd, ent.size);
+        detail::zip_put<std::uint64_t>(cd, ent.size);
+        detail::zip_put<std::uint64_t>(cd, ent.offset);
+      }
+    }
+
+    std::uint64_t n = entries_.size();
+    bool zip64 = n >= 0xffff || cd.size() >= detail::ZIP_MAX32 ||
+                 offset_ >= detail::ZIP_MAX32;
+    std::string end;
+    if (zip64) {
+      std::uint64_t end64_offset = offset_ + cd.size();
+      detail::zip_put<std::uint32_t>(end, 0x06064b50);
+      detail::zip_put<std::uint64_t>(end, 44);
+      detail::zip_put<std::uint16_t>(end, 45);
+      detail::zip_put<std::uint16_t>(end, 45);
+      detail::zip_put<std::uint32_t>(end, 0);
+      detail::zip_put<std::uint32_t>(end, 0);
+      detail::zip_put<std::uint64_t>(end, n);
+      detail::zip_put<std::uint64_t>(end, n);
+      detail::zip_put<std::uint64_t>(end, cd.size());
+      detail::zip_put<std::uint64_t>(end, offset_);
+      detail::zip_put<std::uint32_t>(end, 0x07064b50);
+      detail::zip_put<std::uint32_t>(end, 0);
+      detail::zip_put<std::uint64_t>(end, end64_offset);
+      detail::zip_put<std::uint32_t>(end, 1);
+    }
+    detail::zip_put<std::uint32_t>(end, 0x06054b50);
+    detail::zip_put<std::uint16_t>(end, 0);
+    detail::zip_put<std::uint16_t>(end, 0);
+    detail::zip_put<std::uint16_t>(end, zip64 ? 0xffff : n);
+    detail::zip_put<std::uint16_t>(end, zip64 ? 0xffff : n);
+    detail::zip_put<std::uint32_t>(
+      end, zip64 ? detail::ZIP_MAX32 : std::uint64_t(cd.size()));
+    detail::zip_put<std::uint32_t>(end, zip64 ? detail::ZIP_MAX32 : offset_);
+    detail::zip_put<std::uint16_t>(end, 0);
+
+    f_.write(cd.data(), cd.size());
+    f_.write(end.data(), end.size());
+    f_.close();
+    if (!f_) {
+      detail::npy_error(path_, "write failed");
+    }
+  }
+
+private:
+  struct entry
+  {
+    std::string name;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t crc;
+  };
+
+  std::string path_;
+  std::ofstream f_;
+  std::uint64_t offset_ = 0;
+  std::vector<entry> entries_;
+};
+
+namespace detail
+{
+
+inline void save_npz_add(npz_writer&) {}
+
+template <typename E, typename... Rest>
+inline void save_npz_add(npz_writer& w, const std::string& name, const E& e,
+                         const Rest&... rest)
+{
+  w.add(name, e);
+  save_npz_add(w, rest...);
+}
+
+} // namespace detail
+
+// save_npz(path, "a", a, "b", b, ...)
+template <typename... Args>
+inline void save_npz(const std::string& path, const Args&... args)
+{
+  static_assert(sizeof...(Args) % 2 == 0,
+                "save_npz takes pairs of names and arrays");
+  npz_writer w(path);
+  detail::save_npz_add(w, args...);
+  w.close();
+}
+
+// ======================================================================
+// npz_reader
+//
+// Reads the directory of an uncompressed .npz archive, so that its arrays
+// can be loaded, or mapped, by name. Archives written by np.savez_compressed
+// are not supported.
+
+class npz_reader
+{
+public:
+  explicit npz_reader(const std::string& path) : path_(path)
+  {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+      detail::npy_error(path, "cannot open");
+    }
+    f.seekg(0, std::ios::end);
+    std::uint64_t file_size = f.tellg();
+
+    // the end of central directory record is followed by a comment of up
+    // to 64k
+    std::uint64_t tail = std::min<std::uint64_t>(file_size, 22 + 65535 + 20);
+    std::string buf(tail, '\0');
+    f.seekg(file_size - tail);
+    f.read(&buf[0], tail);
+    std::size_t eocd = std::string::npos;
+    for (std::size_t i = tail >= 22 ? tail - 22 + 1 : 0; i-- > 0;) {
+      if (detail::zip_get(&buf[i], 4) == 0x06054b50) {
+        eocd = i;
+        break;
+      }
+    }
+    if (eocd == std::string::npos) {
+      detail::npy_error(path, "not a zip file");
+    }
+    std::uint64_t n = detail::zip_get(&buf[eocd + 10], 2);
+    std::uint64_t cd_size = detail::zip_get(&buf[eocd + 12], 4);
+    std::uint64_t cd_offset = detail::zip_get(&buf[eocd + 16], 4);
+    if (eocd >= 20 && detail::zip_get(&buf[eocd - 20], 4) == 0x07064b50) {
+      char end64[56];
+      f.seekg(detail::zip_get(&buf[eocd - 20 + 8], 8));
+      if (!f.read(end64, 56) || detail::zip_get(end64, 4) != 0x06064b50) {
+        detail::npy_error(path, "invalid zip64 directory");
+      }
+      n = detail::zip_get(end64 + 32, 8);
+      cd_size = detail::zip_get(end64 + 40, 8);
+      cd_offset = detail::zip_get(end64 + 48, 8);
+    }
+
+    std::string cd(cd_size, '\0');
+    f.seekg(cd_offset);
+    if (!f.read(&cd[0], cd_size)) {
+      detail::npy_error(path, "truncated zip directory");
+    }
+    std::size_t pos = 0;
+    for (std::uint64_t i = 0; i < n; i++) {
+      if (pos + 46 > cd.size() ||
+          detail::zip_get(&cd[pos], 4) != 0x02014b50) {
+        detail::npy_error(path, "invalid zip directory");
+      }
+      const char* p = &cd[pos];
+      entry ent;
+      ent.method = detail::zip_get(p + 10, 2);
+      std::uint64_t size = detail::zip_get(p + 24, 4);
+      std::size_t name_len = detail::zip_get(p + 28, 2);
+      std::size_t extra_len = detail::zip_get(p + 30, 2);
+      std::size_t comment_len = detail::zip_get(p + 32, 2);
+      ent.offset = detail::zip_get(p + 42, 4);
+      ent.name = cd.substr(pos + 46, name_len);
+
+      // zip64 extra field: the saturated sizes and offset, in order
+      const char* extra = p + 46 + name_len;
+      for (std::size_t e = 0; e + 4 <= extra_len;) {
+        std::size_t id = detail::zip_get(extra + e, 2);
+        std::size_t len = detail::zip_get(extra + e + 2, 2);
+        if (id == 1) {
+          const char* v = extra + e + 4;
+          if (size == detail::ZIP_MAX32) {
+            v += 8;
+          }
+          if (detail::zip_get(p + 20, 4) == detail::ZIP_MAX32) {
+            v += 8;
+          }
+          if (ent.offset == detail::ZIP_MAX32) {
+            ent.offset = detail::zip_get(v, 8);
+          }
+        }
+        e += 4 + len;
+      }
+      pos += 46 + name_len + extra_len + comment_len;
+      entries_.push_back(std::move(ent));
+    }
+  }
+
+  // names of the arrays in the archive, without the .npy suffix
+  std::vector<std::string> names() const
+  {
+    std::vector<std::string> result;
+    for (const auto& ent : entries_) {
+      auto name = ent.name;
+      if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0) {
+        name.resize(name.size() - 4);
+      }
+      result.push_back(name);
+    }
+    return result;
+  }
+
+  template <typename T, size_type N>
+  gt::gtensor<T, N> load(const std::string& name) const
+  {
+    return detail::npy_load<T, N>(path_, data_offset(name));
+  }
+
+  template <typename E>
+  void load(const std::string& name, E&& dst) const
+  {
+    using E_ = std::decay_t<E>;
+    auto h = load<std::remove_const_t<gt::expr_value_type<E_>>,
+                  gt::expr_dimension<E_>()>(name);
+    if (h.shape() != dst.shape()) {
+      detail::npy_error(path_, name + ": shape does not match destination");
+    }
+    gt::copy(h, dst);
+  }
+
+  // maps the array in place, which works since members are not compressed
+  template <typename T, size_type N>
+  gt::mmap_gtensor<T, N> load_mmap(const std::string& name,
+                                   map_mode mode = map_mode::read_only) const
+  {
+    return detail::npy_load_mmap<T, N>(path_, data_offset(name), mode);
+  }
+
+private:
+  struct entry
+  {
+    std::string name;
+    std::uint64_t offset;
+    int method;
+  };
+
+  // offset of the .npy data of member name in the archive
+  std::uint64_t data_offset(const std::string& name) const
+  {
+    auto it = std::find_if(
+      entries_.begin(), entries_.end(), [&](const entry& ent) {
+        return ent.name == name || ent.name == name + ".npy";
+      });
+    if (it == entries_.end()) {
+      detail::npy_error(path_, "no array '" + name + "'");
+    }
+    if (it->method != 0) {
+      detail::npy_error(path_, "'" + name + "' is compressed");
+    }
+    std::ifstream f(path_, std::ios::binary);
+    char lh[30];
+    f.seekg(it->offset);
+    if (!f.read(lh, 30) || detail::zip_get(lh, 4) != 0x04034b50) {
+      detail::npy_error(path_, "invalid zip member '" + name + "'");
+    }
+    return it->offset + 30 + detail::zip_get(lh + 26, 2) +
+           detail::zip_get(lh + 28, 2);
+  }
+
+  std::string path_;
+  std::vector<entry> entries_;
+};
+
+template <typename T, size_type N>
+inline gt::gtensor<T, N> load_npz(const std::string& path,
+                                  const std::string& name)
+{
+  return npz_reader(path).load<T, N>(name);
+}
+
+} // namespace gt
+
+#endif // GTENSOR_NPY_H
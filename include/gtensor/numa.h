@@ -0,0 +1,264 @@
+#ifndef GTENSOR_NUMA_H
+#define GTENSOR_NUMA_H
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "defs.h"
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_move_pages) &&     \
+  defined(SYS_get_mempolicy)
+#define GTENSOR_HAVE_NUMA
+#endif
+
+// ======================================================================
+// gt::numa
+//
+// Page placement of host arrays on NUMA systems, using the Linux mbind and
+// move_pages system calls directly, so libnuma is not needed.
+//
+// By default pages are placed on the node of the thread that first touches
+// them. Host fills, copies and assignments are split over the workers the
+// same way, so an array initialized by any of them ends up spread over the
+// nodes the workers run on (given the workers are pinned, e.g. with
+// OMP_PROC_BIND or taskset). interleave() and bind() override this for one
+// array, e.g. for data that is accessed by all threads:
+//
+//   gt::gtensor<double, 3, gt::space::host> f(shape);
+//   gt::numa::interleave(f);
+//   f = ...;
+//
+// Only the pages lying entirely within the array are affected, and pages that
+// have already been touched are migrated. placement() reports how many pages
+// of an array are on each node.
+
+namespace gt
+{
+namespace numa
+{
+
+enum class policy
+{
+  // back to the default, first touch placement
+  local,
+  // round robin over all nodes
+  interleave,
+  // only on the given node
+  bind,
+  // on the given node if possible
+  preferred
+};
+
+namespace detail
+{
+
+// from <numaif.h>
+constexpr int MPOL_DEFAULT_ = 0;
+constexpr int MPOL_PREFERRED_ = 1;
+constexpr int MPOL_BIND_ = 2;
+constexpr int MPOL_INTERLEAVE_ = 3;
+constexpr unsigned MPOL_MF_MOVE_ = 1 << 1;
+
+constexpr int BITS_PER_WORD = sizeof(unsigned long) * CHAR_BIT;
+
+inline std::size_t page_size()
+{
+#if defined(__linux__)
+  static std::size_t size = sysconf(_SC_PAGESIZE);
+  return size;
+#else
+  return 4096;
+#endif
+}
+
+// highest node number in a sysfs node list like "0-3,8"
+inline int max_node_in_list(const std::string& list)
+{
+  int max_node = -1;
+  std::size_t pos = 0;
+  while (pos < list.size()) {
+    std::size_t end = list.find_first_of(",\n", pos);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    std::string range = list.substr(pos, end - pos);
+    std::size_t dash = range.find('-');
+    std::string last =
+      dash == std::string::npos ? range : range.substr(dash + 1);
+    if (!last.empty()) {
+      max_node = std::max(max_node, std::atoi(last.c_str()));
+    }
+    pos = end + 1;
+  }
+  return max_node;
+}
+
+} // namespace detail
+
+// true if the system supports the NUMA system calls
+inline bool available()
+{
+#ifdef GTENSOR_HAVE_NUMA
+  static bool avail =
+    syscall(SYS_get_mempolicy, nullptr, nullptr, 0, nullptr, 0) == 0;
+  return avail;
+#else
+  return false;
+#endif
+}
+
+// number of NUMA nodes, i.e. one more than the highest node number
+inline int num_nodes()
+{
+  static int n = [] {
+    std::ifstream file("/sys/devices/system/node/possible");
+    std::string list;
+    std::getline(file, list);
+    return std::max(detail::max_node_in_list(list) + 1, 1);
+  }();
+  return n;
+}
+
+/*! Set the placement policy for the pages lying entirely within [p, p +
+ * nbytes), migrating those already touched. node is only used by bind and
+ * preferred. Returns false if the policy could not be applied.
+ */
+inline bool set_policy(void* p, std::size_t nbytes, policy pol, int node = 0)
+{
+#ifdef GTENSOR_HAVE_NUMA
+  if (!available()) {
+    return false;
+  }
+  std::size_t page = detail::page_size();
+  auto addr = reinterpret_cast<std::uintptr_t>(p);
+  std::uintptr_t begin = (addr + page - 1) / page * page;
+  std::uintptr_t end = (addr + nbytes) / page * page;
+  if (begin >= end) {
+    return true;
+  }
+
+  int nnodes = num_nodes();
+  if (node < 0 || node >= nnodes) {
+    return false;
+  }
+  std::vector<unsigned long> mask(
+    (nnodes + detail::BITS_PER_WORD - 1) / detail::BITS_PER_WORD, 0);
+  auto set_node = [&](int i) {
+    mask[i / detail::BITS_PER_WORD] |= 1ul << (i % detail::BITS_PER_WORD);
+  };
+  int mode = detail::MPOL_DEFAULT_;
+  switch (pol) {
+    case policy::local: break;
+    case policy::interleave:
+      mode = detail::MPOL_INTERLEAVE_;
+      for (int i = 0; i < nnodes; i++) {
+        set_node(i);
+      }
+      break;
+    case policy::bind:
+      mode = detail::MPOL_BIND_;
+      set_node(node);
+      break;
+    case policy::preferred:
+      mode = detail::MPOL_PREFERRED_;
+      set_node(node);
+      break;
+  }
+  // the kernel reads maxnode - 1 bits
+  unsigned long maxnode = mask.size() * detail::BITS_PER_WORD + 1;
+  return syscall(SYS_mbind, begin, end - begin, mode,
+                 mode == detail::MPOL_DEFAULT_ ? nullptr : mask.data(),
+                 mode == detail::MPOL_DEFAULT_ ? 0 : maxnode,
+                 detail::MPOL_MF_MOVE_) == 0;
+#else
+  return false;
+#endif
+}
+
+/*! Node of each page overlapping [p, p + nbytes), or a negative errno for
+ * pages that cannot be queried, in particular -ENOENT for pages that have not
+ * been touched yet. Empty if NUMA is not available.
+ */
+inline std::vector<int> page_nodes(const void* p, std::size_t nbytes)
+{
+  std::vector<int> nodes;
+#ifdef GTENSOR_HAVE_NUMA
+  if (!available() || nbytes == 0) {
+    return nodes;
+  }
+  std::size_t page = detail::page_size();
+  auto addr = reinterpret_cast<std::uintptr_t>(p);
+  std::uintptr_t begin = addr / page * page;
+  std::size_t npages = (addr + nbytes - begin + page - 1) / page;
+  std::vector<void*> pages(npages);
+  for (std::size_t i = 0; i < npages; i++) {
+    pages[i] = reinterpret_cast<void*>(begin + i * page);
+  }
+  nodes.resize(npages);
+  if (syscall(SYS_move_pages, 0, npages, pages.data(), nullptr, nodes.data(),
+              0) != 0) {
+    nodes.clear();
+  }
+#endif
+  return nodes;
+}
+
+/*! Number of pages of [p, p + nbytes) on each node; pages that have not been
+ * touched yet are not counted. Empty if NUMA is not available.
+ */
+inline std::vector<size_type> placement(const void* p, std::size_t nbytes)
+{
+  auto nodes = page_nodes(p, nbytes);
+  std::vector<size_type> counts;
+  if (!nodes.empty()) {
+    counts.resize(num_nodes(), 0);
+    for (int node : nodes) {
+      if (node >= 0 && node < int(counts.size())) {
+        counts[node]++;
+      }
+    }
+  }
+  return counts;
+}
+
+// overloads for host containers
+
+template <typename E>
+inline bool set_policy(E& e, policy pol, int node = 0)
+{
+  return set_policy(e.data(), e.size() * sizeof(*e.data()), pol, node);
+}
+
+template <typename E>
+inline bool interleave(E& e)
+{
+  return set_policy(e, policy::interleave);
+}
+
+template <typename E>
+inline bool bind(E& e, int node)
+{
+  return set_policy(e, policy::bind, node);
+}
+
+template <typename E>
+inline std::vector<size_type> placement(const E& e)
+{
+  return placement(e.data(), e.size() * sizeof(*e.data()));
+}
+
+} // namespace numa
+} // namespace gt
+
+#endif // GTENSOR_NUMA_H
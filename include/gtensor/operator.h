@@ -156,8 +156,8 @@ template <typename E,
           typename Enable = std::enable_if_t<is_expression<E>::value>>
 inline std::ostream& operator<<(std::ostream& os, const E& e)
 {
-  detail::expression_printer<expr_dimension<E>(), expr_space_type<E>>::print_to(
-    os, e);
+  detail::expression_printer<expr_dimension<E>(),
+                             expr_storage_space<E>>::print_to(os, e);
   return os;
 }
 
@@ -427,8 +427,9 @@ struct equals<N1, N2, space::host, space::device>
 template <typename E1, typename E2>
 bool operator==(const expression<E1>& e1, const expression<E2>& e2)
 {
-  return detail::equals<E1::dimension(), E2::dimension(), expr_space_type<E1>,
-                        expr_space_type<E2>>::run(e1.derived(), e2.derived());
+  return detail::equals<E1::dimension(), E2::dimension(),
+                        expr_storage_space<E1>, expr_storage_space<E2>>::
+    run(e1.derived(), e2.derived());
 }
 
 template <typename E1, typename E2>
@@ -5,21 +5,164 @@
 
 #if defined(GTENSOR_DEVICE_CUDA) || defined(GTENSOR_DEVICE_HIP)
 #include <thrust/extrema.h>
+#include <thrust/iterator/counting_iterator.h>
 #include <thrust/reduce.h>
 #include <thrust/transform_reduce.h>
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdlib>
 #include <functional>
+#include <limits>
+#include <mutex>
 #include <numeric>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 //#include <iostream>
 
 namespace gt
 {
 
+namespace detail
+{
+
+// Expressions in space S accepted by the reductions. Host reductions evaluate
+// any expression on the fly, device containers use the backend specific
+// implementations on their data pointer, and other device expressions are
+// evaluated on the fly inside the device reduction.
+template <typename E, typename S, typename Enable = void>
+struct is_reducible : std::false_type
+{};
+
+template <typename E, typename S>
+struct is_reducible<E, S, std::enable_if_t<is_expression<E>::value>>
+  : std::is_same<expr_space_type<E>, S>
+{};
+
+// generators (space::any) are evaluated on the host
+template <typename E>
+using is_host_reducible =
+  std::integral_constant<bool, is_reducible<E, space::host>::value ||
+                                 is_reducible<E, space::any>::value>;
+
+template <typename E>
+using is_device_lazy_reducible =
+  std::integral_constant<bool, is_reducible<E, space::device>::value &&
+                                 !has_data_method_v<E>>;
+
+template <typename T>
+struct UnaryOpIdentity
+{
+  GT_INLINE T operator()(T a) const { return a; }
+};
+
+struct BinaryOpMax
+{
+  template <typename T>
+  GT_INLINE T operator()(const T& a, const T& b) const
+  {
+    return b > a ? b : a;
+  }
+};
+
+struct BinaryOpMin
+{
+  template <typename T>
+  GT_INLINE T operator()(const T& a, const T& b) const
+  {
+    return b < a ? b : a;
+  }
+};
+
+// Accumulators combine, in order, the partial reductions of consecutive
+// pieces of at most `piece` elements. The serial accumulator keeps a running
+// total of arbitrarily long pieces.
+template <typename T, typename Op>
+struct serial_accumulator
+{
+  static constexpr size_type piece = std::numeric_limits<size_type>::max();
+
+  bool empty = true;
+  T acc{};
+
+  GT_INLINE void add(const T& value, const Op& op)
+  {
+    acc = empty ? value : T(op(acc, value));
+    empty = false;
+  }
+
+  GT_INLINE T result(const Op& op) const { return acc; }
+};
+
+// Pairwise (cascade) accumulator: pieces are short, and their results are
+// merged like the digits of a binary counter, so that the rounding error of a
+// sum grows with the logarithm of the number of pieces rather than linearly.
+template <typename T, typename Op>
+struct pairwise_accumulator
+{
+  static constexpr size_type piece = 128;
+  static constexpr int MAX_LEVELS = 48;
+
+  int top = 0;
+  int levels[MAX_LEVELS] = {};
+  T values[MAX_LEVELS] = {};
+
+  GT_INLINE void add(const T& value, const Op& op)
+  {
+    values[top] = value;
+    levels[top] = 0;
+    top++;
+    while (top >= 2 && levels[top - 1] == levels[top - 2]) {
+      values[top - 2] = op(values[top - 2], values[top - 1]);
+      levels[top - 2]++;
+      top--;
+    }
+  }
+
+  GT_INLINE T result(const Op& op) const
+  {
+    if (top == 0) {
+      return T{};
+    }
+    T acc = values[top - 1];
+    for (int i = top - 2; i >= 0; i--) {
+      acc = op(values[i], acc);
+    }
+    return acc;
+  }
+};
+
+// transform(e[idx]) at the column major flat index i of a kernel expression,
+// used to feed lazy expressions to flat device reductions
+template <typename K, typename Strides, typename Transform>
+struct flat_expression_transform
+{
+  K k;
+  Strides strides;
+  Transform transform;
+
+  GT_INLINE auto operator()(size_type i) const
+  {
+    return transform(index_expression(k, unravel(i, strides)));
+  }
+};
+
+template <typename E, typename Transform>
+inline auto make_flat_expression_transform(const E& e, Transform transform)
+{
+  auto k = e.to_kernel();
+  auto strides = calc_strides(e.shape());
+  return flat_expression_transform<decltype(k), decltype(strides), Transform>{
+    k, strides, transform};
+}
+
+} // namespace detail
+
 #if defined(GTENSOR_DEVICE_CUDA) || defined(GTENSOR_DEVICE_HIP)
 
 namespace detail
@@ -135,6 +278,21 @@ inline OutputType transform_reduce(const Container& a, OutputType init,
                                   reduction_op);
 }
 
+template <typename E, typename OutputType, typename BinaryReductionOp,
+          typename UnaryTransformOp,
+          std::enable_if_t<detail::is_device_lazy_reducible<E>::value, int> = 0>
+inline OutputType transform_reduce(const E& e, OutputType init,
+                                   BinaryReductionOp reduction_op,
+                                   UnaryTransformOp transform_op,
+                                   gt::stream_view stream = gt::stream_view{})
+{
+  auto f = detail::make_flat_expression_transform(e, transform_op);
+  thrust::counting_iterator<size_type> begin(0);
+  thrust::counting_iterator<size_type> end(calc_size(e.shape()));
+  auto exec = stream.get_execution_policy();
+  return thrust::transform_reduce(exec, begin, end, f, init, reduction_op);
+}
+
 #elif defined(GTENSOR_DEVICE_SYCL)
 
 template <typename Container,
@@ -239,17 +397,6 @@ inline auto min(const Container& a, gt::stream_view stream = gt::stream_view{})
   return min_buf.get_host_access()[0];
 }
 
-namespace detail
-{
-
-template <typename T>
-struct UnaryOpIdentity
-{
-  GT_INLINE T operator()(T a) const { return a; }
-};
-
-} // namespace detail
-
 template <typename Container, typename OutputType, typename BinaryReductionOp,
           typename = std::enable_if_t<
             has_data_method_v<Container> &&
@@ -290,202 +437,1969 @@ inline OutputType transform_reduce(const Container& a, OutputType init,
   return result_buf.get_host_access()[0];
 }
 
+template <typename E, typename OutputType, typename BinaryReductionOp,
+          typename UnaryTransformOp,
+          std::enable_if_t<detail::is_device_lazy_reducible<E>::value, int> = 0>
+inline OutputType transform_reduce(const E& e, OutputType init,
+                                   BinaryReductionOp reduction_op,
+                                   UnaryTransformOp transform_op,
+                                   gt::stream_view stream = gt::stream_view{})
+{
+  sycl::queue& q = stream.get_backend_stream();
+  OutputType result = init;
+  sycl::buffer<OutputType> result_buf{&result, 1};
+  {
+    sycl::range<1> range(calc_size(e.shape()));
+    auto f = detail::make_flat_expression_transform(e, transform_op);
+    auto ev = q.submit([&](sycl::handler& cgh) {
+      auto reducer = sycl::reduction(result_buf, cgh, init, reduction_op);
+      cgh.parallel_for(range, reducer, [=](sycl::id<1> idx, auto& r) {
+        r.combine(f(idx[0]));
+      });
+    });
+    ev.wait();
+  }
+  return result_buf.get_host_access()[0];
+}
+
 #endif // device implementations
 
-template <typename Container,
-          typename = std::enable_if_t<
-            has_data_method_v<Container> &&
-            std::is_same<typename Container::space_type, space::host>::value>,
-          typename = int>
-inline auto sum(const Container& a, gt::stream_view stream = gt::stream_view{})
+#ifdef GTENSOR_HAVE_DEVICE
+
+// device reductions of lazy expressions, evaluated inside the reduction
+// kernel rather than into a temporary
+
+template <typename E,
+          std::enable_if_t<detail::is_device_lazy_reducible<E>::value, int> = 0>
+inline auto sum(const E& e, gt::stream_view stream = gt::stream_view{})
 {
-  using T = typename Container::value_type;
-  auto data = a.data();
-  // TODO: this assumes type has an initializer from int(0), which should be
-  // true for all numeric types encountered in practice, but this is ugly
-  T tmp = 0;
-  for (size_type i = 0; i < a.size(); i++) {
-    tmp += data[i];
-  }
-  return tmp;
+  using T = expr_value_type<E>;
+  return transform_reduce(e, T(0), gt::ops::plus{},
+                          detail::UnaryOpIdentity<T>{}, stream);
 }
 
-template <typename Container,
-          typename = std::enable_if_t<
-            has_data_method_v<Container> &&
-            std::is_same<typename Container::space_type, space::host>::value>,
-          typename = int>
-inline auto max(const Container& a, gt::stream_view stream = gt::stream_view{})
+template <typename E,
+          std::enable_if_t<detail::is_device_lazy_reducible<E>::value, int> = 0>
+inline auto max(const E& e, gt::stream_view stream = gt::stream_view{})
 {
-  using T = typename Container::value_type;
-  auto data = a.data();
-  T max_value = data[0];
-  T current_value;
-  for (size_type i = 1; i < a.size(); i++) {
-    current_value = data[i];
-    if (current_value > max_value)
-      max_value = current_value;
-  }
-  return max_value;
+  using T = expr_value_type<E>;
+  return transform_reduce(e, std::numeric_limits<T>::lowest(),
+                          detail::BinaryOpMax{}, detail::UnaryOpIdentity<T>{},
+                          stream);
 }
 
-template <typename Container,
-          typename = std::enable_if_t<
-            has_data_method_v<Container> &&
-            std::is_same<typename Container::space_type, space::host>::value>,
-          typename = int>
-inline auto min(const Container& a, gt::stream_view stream = gt::stream_view{})
+template <typename E,
+          std::enable_if_t<detail::is_device_lazy_reducible<E>::value, int> = 0>
+inline auto min(const E& e, gt::stream_view stream = gt::stream_view{})
 {
-  using T = typename Container::value_type;
-  auto data = a.data();
-  T min_value = data[0];
-  T current_value;
-  for (size_type i = 0; i < a.size(); i++) {
-    current_value = data[i];
-    if (current_value < min_value)
-      min_value = current_value;
-  }
-  return min_value;
+  using T = expr_value_type<E>;
+  return transform_reduce(e, std::numeric_limits<T>::max(),
+                          detail::BinaryOpMin{}, detail::UnaryOpIdentity<T>{},
+                          stream);
 }
 
-template <typename Container, typename OutputType, typename BinaryReductionOp,
-          typename = std::enable_if_t<
-            has_data_method_v<Container> &&
-            std::is_same<typename Container::space_type, space::host>::value>,
-          typename = int>
-inline OutputType reduce(const Container& a, OutputType init,
+template <typename E, typename OutputType, typename BinaryReductionOp,
+          std::enable_if_t<detail::is_device_lazy_reducible<E>::value, int> = 0>
+inline OutputType reduce(const E& e, OutputType init,
                          BinaryReductionOp reduction_op,
                          gt::stream_view stream = gt::stream_view{})
 {
-  using P = const typename Container::value_type*;
-  P begin(a.data());
-  P end(a.data() + a.size());
-  return std::accumulate(begin, end, init, reduction_op);
+  return transform_reduce(e, init, reduction_op,
+                          detail::UnaryOpIdentity<OutputType>{}, stream);
 }
 
-template <typename Container, typename OutputType, typename BinaryReductionOp,
-          typename UnaryTransformOp,
-          typename = std::enable_if_t<
-            has_data_method_v<Container> &&
-            std::is_same<typename Container::space_type, space::host>::value>,
-          typename = int>
-inline OutputType transform_reduce(const Container& a, OutputType init,
-                                   BinaryReductionOp reduction_op,
-                                   UnaryTransformOp transform_op,
-                                   gt::stream_view stream = gt::stream_view{})
+#endif // GTENSOR_HAVE_DEVICE
+
+// ======================================================================
+// host reductions
+//
+// The input is split across the host workers, and each part is reduced with
+// several independent accumulators so the loop has no serial dependency
+// chain and can be vectorized. By default there is one partial result per
+// worker, so floating point results may round differently for different
+// numbers of threads. In deterministic mode the input is instead split into
+// fixed size blocks whose partial results are combined in a fixed tree, which
+// makes results bitwise reproducible for any number of threads. It can also
+// be enabled with the GTENSOR_DETERMINISTIC_REDUCTIONS environment variable.
+
+namespace detail
+{
+
+constexpr int HOST_REDUCE_LANES = 8;
+constexpr size_type HOST_REDUCE_BLOCK = 16 * 1024;
+
+inline std::atomic<bool>& deterministic_reductions_flag()
+{
+  static std::atomic<bool> flag{[] {
+    const char* env = std::getenv("GTENSOR_DETERMINISTIC_REDUCTIONS");
+    return env != nullptr && std::atoi(env) != 0;
+  }()};
+  return flag;
+}
+
+// reduce load(i) for i in the non-empty range [begin, end), using
+// HOST_REDUCE_LANES accumulators that are kept in registers (an array of
+// accumulators ends up in memory)
+template <typename T, typename Op, typename Load>
+inline T host_reduce_range(size_type begin, size_type end, Op& op, Load& load)
 {
-  using P = const typename Container::value_type*;
-  P begin(a.data());
-  P end(a.data() + a.size());
-#if __cplusplus >= 201703L
-  return std::transform_reduce(begin, end, init, reduction_op, transform_op);
-#else
-  for (P dp = begin; dp < end; dp++) {
-    init = reduction_op(init, transform_op(*dp));
+  size_type i = begin;
+  if (end - begin < HOST_REDUCE_LANES) {
+    T acc = load(i++);
+    for (; i < end; i++) {
+      acc = op(acc, load(i));
+    }
+    return acc;
   }
-  return init;
-#endif
+
+  T a0 = load(i), a1 = load(i + 1), a2 = load(i + 2), a3 = load(i + 3);
+  T a4 = load(i + 4), a5 = load(i + 5), a6 = load(i + 6), a7 = load(i + 7);
+  for (i += 8; i + 8 <= end; i += 8) {
+    a0 = op(a0, load(i));
+    a1 = op(a1, load(i + 1));
+    a2 = op(a2, load(i + 2));
+    a3 = op(a3, load(i + 3));
+    a4 = op(a4, load(i + 4));
+    a5 = op(a5, load(i + 5));
+    a6 = op(a6, load(i + 6));
+    a7 = op(a7, load(i + 7));
+  }
+  for (; i < end; i++) {
+    a0 = op(a0, load(i));
+  }
+  return op(op(op(a0, a4), op(a2, a6)), op(op(a1, a5), op(a3, a7)));
 }
 
-template <typename Eout, typename Ein>
-inline void sum_axis_to(Eout&& out, Ein&& in, int axis,
-                        gt::stream_view stream = gt::stream_view{})
+// reduce over [0, n) with the associative op, n > 0, where
+// reduce_range(begin, end) reduces the non-empty range [begin, end)
+template <typename T, typename Op, typename ReduceRange>
+inline T host_reduce_ranges(size_type n, Op& op, ReduceRange&& reduce_range)
 {
-  using Sout = expr_space_type<Eout>;
-  using Tout = expr_value_type<Eout>;
-  using Sin = expr_space_type<Ein>;
-  using Tin = expr_value_type<Ein>;
-  using shape_type = expr_shape_type<Eout>;
+  assert(n > 0);
+  if (deterministic_reductions_flag()) {
+    const size_type nblocks = gt::div_ceil(n, HOST_REDUCE_BLOCK);
+    std::vector<T> partial(nblocks);
+    gt::backend::host::parallel_for(
+      nblocks, 1, [&](size_type begin, size_type end) {
+        for (size_type b = begin; b < end; b++) {
+          partial[b] = reduce_range(b * HOST_REDUCE_BLOCK,
+                                    std::min(n, (b + 1) * HOST_REDUCE_BLOCK));
+        }
+      });
+    for (size_type w = 1; w < nblocks; w *= 2) {
+      for (size_type b = 0; b + w < nblocks; b += 2 * w) {
+        partial[b] = op(partial[b], partial[b + w]);
+      }
+    }
+    return partial[0];
+  }
 
-  static_assert(std::is_same<Sout, Sin>::value,
-                "out and in expressions must be in the same space");
-  static_assert(std::is_same<Tout, Tin>::value,
-                "out and in expressions must have the same value type");
+  std::vector<std::pair<size_type, T>> partial;
+  std::mutex partial_mutex;
+  gt::backend::host::parallel_for(
+    n, HOST_REDUCE_BLOCK, [&](size_type begin, size_type end) {
+      T value = reduce_range(begin, end);
+      std::lock_guard<std::mutex> lock(partial_mutex);
+      partial.emplace_back(begin, value);
+    });
+  std::sort(partial.begin(), partial.end(),
+            [](const std::pair<size_type, T>& a,
+               const std::pair<size_type, T>& b) { return a.first < b.first; });
+  T result = partial[0].second;
+  for (size_type p = 1; p < partial.size(); p++) {
+    result = op(result, partial[p].second);
+  }
+  return result;
+}
 
-  constexpr auto dims_out = expr_dimension<Eout>();
-  constexpr auto dims_in = expr_dimension<Ein>();
+// add the reductions of pieces of [begin, end) to the accumulator acc
+template <typename T, typename Acc, typename Op, typename Load>
+inline void host_accumulate_range(Acc& acc, size_type begin, size_type end,
+                                  Op& op, Load& load)
+{
+  while (begin < end) {
+    size_type piece_end = end - begin > Acc::piece ? begin + Acc::piece : end;
+    acc.add(host_reduce_range<T>(begin, piece_end, op, load), op);
+    begin = piece_end;
+  }
+}
 
-  static_assert(
-    dims_out == dims_in - 1,
-    "out expression must have one less dimension than in expression");
+// Reduce transform(e[i], i) over all elements of the non-empty host
+// expression e, where i is the column major flat index, combining partial
+// results through the accumulator type Acc. Expressions supported by
+// host_strided_evaluator are walked along runs of their collapsed dimension 0,
+// others along dimension 0 through their multi-index operator().
+template <typename T, typename Acc, typename E, typename Op,
+          typename Transform>
+inline T host_accumulate_expression(const E& e, Op& op, Transform& transform,
+                                    std::true_type)
+{
+  constexpr int N = expr_dimension<E>();
+  using index_type = sarray<size_type, N>;
+  const auto shape = e.shape();
 
-  auto shape_in = in.shape();
-  auto shape_out = out.shape();
-  auto shape_out_expected = remove(shape_in, axis);
+  host_strided_evaluator<const E> eval(e);
+  sarray<int, N> dims;
+  index_type cshape;
+  const int ndim = host_collapse_dims(
+    shape, [&](auto&& pred) { return eval.all_strides(pred); }, dims, cshape);
+  eval.collapse(dims, ndim);
+  const bool contiguous =
+    eval.all_strides([](const auto& strides) { return strides[0] == 1; });
 
-  assert(shape_out == shape_out_expected);
+  return host_reduce_ranges<T>(
+    calc_size(shape), op, [&](size_type begin, size_type end) {
+      auto ev = eval;
+      index_type idx;
+      size_type pos = begin;
+      // ndim <= N, bounding by N as well lets the compiler see that
+      for (int g = 0; g < ndim && g < int(N); g++) {
+        idx[g] = pos % cshape[g];
+        pos /= cshape[g];
+      }
 
-  auto k_out = out.to_kernel();
-  auto k_in = in.to_kernel();
+      Acc acc;
+      while (begin < end) {
+        ev.seek(idx, ndim);
+        size_type row_end = std::min(cshape[0], idx[0] + (end - begin));
+        // flat index of row element i, modulo 2^bits
+        size_type offset = begin - idx[0];
+        if (contiguous) {
+          auto load = [&](size_type i) -> T {
+            return transform(ev.get_contiguous(i), offset + i);
+          };
+          host_accumulate_range<T>(acc, idx[0], row_end, op, load);
+        } else {
+          auto load = [&](size_type i) -> T {
+            return transform(ev.get(i), offset + i);
+          };
+          host_accumulate_range<T>(acc, idx[0], row_end, op, load);
+        }
 
-  // Note: use logical indexing strides, not internal strides which may be
-  // for addressing the underlying data for gview
-  auto strides_out = calc_strides(shape_out);
-  auto strides_in = calc_strides(shape_in);
-
-  auto flat_out_shape = gt::shape(static_cast<int>(out.size()));
-  int reduction_length = in.shape(axis);
-
-  gt::launch<1, Sout>(
-    flat_out_shape,
-    GT_LAMBDA(int i) {
-      auto idx_out = unravel(i, strides_out);
-      auto idx_in = insert(idx_out, axis, 0);
-      Tin tmp = k_in[idx_in];
-      idx_in[axis]++;
-      for (int j = 1; j < reduction_length; j++) {
-        tmp = tmp + k_in[idx_in];
-        idx_in[axis]++;
+        begin += row_end - idx[0];
+        idx[0] = 0;
+        for (int g = 1; g < ndim && g < int(N); g++) {
+          if (++idx[g] < cshape[g]) {
+            break;
+          }
+          idx[g] = 0;
+        }
       }
-      k_out[idx_out] = tmp;
-    },
-    stream);
+      return acc.result(op);
+    });
 }
 
-template <typename E>
-auto norm_linf(const E& e, gt::stream_view stream = gt::stream_view{})
+template <typename T, typename Acc, typename E, typename Op,
+          typename Transform>
+inline T host_accumulate_expression(const E& e, Op& op, Transform& transform,
+                                    std::false_type)
 {
-  // FIXME, the gt::eval is a workaround for gt::max only handling containers
-  return gt::max(gt::eval(gt::abs(e)), stream);
+  using shape_type = expr_shape_type<E>;
+  const shape_type shape = e.shape();
+  const auto strides = calc_strides(shape);
+
+  return host_reduce_ranges<T>(
+    calc_size(shape), op, [&](size_type begin, size_type end) {
+      shape_type idx = unravel(begin, strides);
+
+      Acc acc;
+      while (begin < end) {
+        size_type row_begin = idx[0];
+        size_type row_end =
+          std::min<size_type>(shape[0], row_begin + (end - begin));
+        size_type offset = begin - row_begin;
+        auto load = [&](size_type i) -> T {
+          idx[0] = i;
+          return transform(index_expression(e, idx), offset + i);
+        };
+        host_accumulate_range<T>(acc, row_begin, row_end, op, load);
+
+        begin += row_end - row_begin;
+        idx[0] = 0;
+        for (int d = 1; d < int(shape.size()); d++) {
+          if (++idx[d] < shape[d]) {
+            break;
+          }
+          idx[d] = 0;
+        }
+      }
+      return acc.result(op);
+    });
 }
 
-namespace detail
+template <typename T, typename Acc, typename E, typename Op,
+          typename Transform>
+inline T host_accumulate_expression(const E& e, Op op, Transform transform)
 {
+  using strided =
+    std::integral_constant<bool, host_strided_evaluator<const E>::enabled>;
+  return host_accumulate_expression<T, Acc>(e, op, transform, strided{});
+}
 
-template <typename Tin, typename Tout = Tin, typename Enable = void>
-struct UnaryOpNorm
+// transform(value), ignoring the flat index
+template <typename Transform>
+struct value_transform
 {
-  GT_INLINE Tout operator()(Tin a) const { return a * a; }
+  Transform transform;
+
+  template <typename V>
+  GT_INLINE auto operator()(const V& value, size_type i) const
+  {
+    return transform(value);
+  }
 };
 
-template <typename Tin, typename Tout>
-struct UnaryOpNorm<Tin, Tout,
-                   gt::meta::void_t<std::enable_if_t<gt::is_complex_v<Tin>>>>
+template <typename T, typename E, typename Op, typename Transform>
+inline T host_reduce_expression(const E& e, Op op, Transform transform)
 {
-  GT_INLINE Tout operator()(Tin a) const { return gt::norm(a); }
-};
+  return host_accumulate_expression<T, serial_accumulator<T, Op>>(
+    e, op, value_transform<Transform>{transform});
+}
 
 } // namespace detail
 
-/*! Reduction helper implementing sum of squares on arbitrary expressions. For
- * complex valued arrays, uses `gt::norm` instead of square, so it calculates
- * the L2 norm squared.
- *
- * If e is not a container type, it will be evaluated into a temporary array, so
- * this may not be the most efficient approach in some cases. This is a
- * limitation of the current reduction implementations using low level pointers,
- * passed down to thrust backend instead of logical gtensor expression index
- * pointers.
+/*! Make host reductions bitwise reproducible independent of the number of
+ * threads, see above.
  */
-template <typename E>
-auto sum_squares(const E& e, gt::stream_view stream = gt::stream_view{})
+inline void set_deterministic_reductions(bool deterministic)
 {
-  // FIXME, the gt::eval is a workaround for gt::transform_reduce only handling
-  // containers
-  using ValueType = expr_value_type<E>;
-  using Real = gt::complex_subtype_t<ValueType>;
-  return gt::transform_reduce(gt::eval(e), 0.0, std::plus<>{},
-                              detail::UnaryOpNorm<ValueType, Real>{}, stream);
+  detail::deterministic_reductions_flag() = deterministic;
+}
+
+inline bool get_deterministic_reductions()
+{
+  return detail::deterministic_reductions_flag();
+}
+
+template <typename E,
+          std::enable_if_t<detail::is_host_reducible<E>::value, int> = 0>
+inline auto sum(const E& e, gt::stream_view stream = gt::stream_view{})
+{
+  gt::detail::host_stream_wait(stream);
+  using T = expr_value_type<E>;
+  // TODO: this assumes type has an initializer from int(0), which should be
+  // true for all numeric types encountered in practice, but this is ugly
+  if (calc_size(e.shape()) == 0) {
+    return T(0);
+  }
+  return detail::host_reduce_expression<T>(e, std::plus<T>{},
+                                           detail::UnaryOpIdentity<T>{});
+}
+
+template <typename E,
+          std::enable_if_t<detail::is_host_reducible<E>::value, int> = 0>
+inline auto max(const E& e, gt::stream_view stream = gt::stream_view{})
+{
+  gt::detail::host_stream_wait(stream);
+  using T = expr_value_type<E>;
+  return detail::host_reduce_expression<T>(e, detail::BinaryOpMax{},
+                                           detail::UnaryOpIdentity<T>{});
+}
+
+template <typename E,
+          std::enable_if_t<detail::is_host_reducible<E>::value, int> = 0>
+inline auto min(const E& e, gt::stream_view stream = gt::stream_view{})
+{
+  gt::detail::host_stream_wait(stream);
+  using T = expr_value_type<E>;
+  return detail::host_reduce_expression<T>(e, detail::BinaryOpMin{},
+                                           detail::UnaryOpIdentity<T>{});
+}
+
+template <typename E, typename OutputType, typename BinaryReductionOp,
+          std::enable_if_t<detail::is_host_reducible<E>::value, int> = 0>
+inline OutputType reduce(const E& e, OutputType init,
+                         BinaryReductionOp reduction_op,
+                         gt::stream_view stream = gt::stream_view{})
+{
+  gt::detail::host_stream_wait(stream);
+  if (calc_size(e.shape()) == 0) {
+    return init;
+  }
+  return reduction_op(init, detail::host_reduce_expression<OutputType>(
+                              e, reduction_op,
+                              detail::UnaryOpIdentity<OutputType>{}));
+}
+
+template <typename E, typename OutputType, typename BinaryReductionOp,
+          typename UnaryTransformOp,
+          std::enable_if_t<detail::is_host_reducible<E>::value, int> = 0>
+inline OutputType transform_reduce(const E& e, OutputType init,
+                                   BinaryReductionOp reduction_op,
+                                   UnaryTransformOp transform_op,
+                                   gt::stream_view stream = gt::stream_view{})
+{
+  gt::detail::host_stream_wait(stream);
+  if (calc_size(e.shape()) == 0) {
+    return init;
+  }
+  return reduction_op(init, detail::host_reduce_expression<OutputType>(
+                              e, reduction_op, transform_op));
+}
+
+// ======================================================================
+// axis reductions
+//
+// reduce_axis_to(out, in, axes, op) reduces in over the dimensions listed in
+// axes with the associative op, and writes the result to out, whose shape is
+// that of in with the reduced dimensions removed. Each output element starts
+// from the first element of its reduced slice, so no identity is needed.
+//
+// If there are enough output elements to keep all workers busy, each one is
+// computed by a single worker walking its reduced slice. Otherwise, e.g. when
+// reducing a long axis into a small output, the reduced slices are split into
+// chunks that are reduced in parallel, and the partial results are combined
+// in a second pass.
+
+namespace detail
+{
+
+// minimum number of reduced elements per chunk, and number of independent
+// partial reductions to aim for on the device
+constexpr size_type AXIS_REDUCE_MIN_CHUNK = 256;
+constexpr size_type AXIS_REDUCE_DEVICE_PARALLELISM = 64 * 1024;
+
+// Maps (output element, reduced element) pairs to input indices, with
+// reduced elements numbered in column major order over the reduced axes
+template <size_type N, size_type M>
+struct axis_reduction_index
+{
+  sarray<int, N - M> kept;
+  sarray<int, M> axes;
+  gt::shape_type<N - M> strides_out;
+  gt::shape_type<M> shape_red;
+
+  GT_INLINE gt::shape_type<N> first(size_type i_out, size_type r) const
+  {
+    auto idx_out = unravel(i_out, strides_out);
+    gt::shape_type<N> idx;
+    for (size_type d = 0; d < N - M; d++) {
+      idx[kept[d]] = idx_out[d];
+    }
+    for (size_type m = 0; m < M; m++) {
+      idx[axes[m]] = r % shape_red[m];
+      r /= shape_red[m];
+    }
+    return idx;
+  }
+
+  GT_INLINE void next(gt::shape_type<N>& idx) const
+  {
+    for (size_type m = 0; m < M; m++) {
+      if (++idx[axes[m]] < shape_red[m]) {
+        return;
+      }
+      idx[axes[m]] = 0;
+    }
+  }
+
+  // reduce load(k[idx]) over the reduced elements [r_begin, r_end) of output
+  // element i_out, in pieces combined through the accumulator type Acc
+  template <typename T, typename Acc, typename K, typename Op, typename Load>
+  GT_INLINE T reduce(const K& k, const Op& op, const Load& load,
+                     size_type i_out, size_type r_begin, size_type r_end) const
+  {
+    auto idx = first(i_out, r_begin);
+    Acc acc;
+    for (size_type r = r_begin; r < r_end;) {
+      size_type piece_end = r_end - r > Acc::piece ? r + Acc::piece : r_end;
+      T value = load(index_expression(k, idx));
+      for (r++; r < piece_end; r++) {
+        next(idx);
+        value = op(value, load(index_expression(k, idx)));
+      }
+      acc.add(value, op);
+      next(idx);
+    }
+    return acc.result(op);
+  }
+};
+
+template <typename S>
+struct axis_reducer;
+
+template <>
+struct axis_reducer<space::host>
+{
+  template <typename T, typename Acc, typename KOut, typename KIn,
+            typename Index, typename Op, typename Load, typename Result>
+  static void run(KOut k_out, KIn k_in, const Index& index, Op op, Load load,
+                  Result result, size_type n_out, size_type n_red,
+                  gt::stream_view stream)
+  {
+    gt::detail::host_stream_submit(stream, [=]() mutable {
+      auto strides_out = index.strides_out;
+      size_type nchunks = std::min<size_type>(
+        gt::div_ceil<size_type>(gt::backend::host::get_num_threads(), n_out),
+        n_red / AXIS_REDUCE_MIN_CHUNK);
+
+      if (nchunks <= 1) {
+        size_type grain = gt::div_ceil(HOST_REDUCE_BLOCK, n_red);
+        gt::backend::host::parallel_for(
+          n_out, grain, [&](size_type begin, size_type end) {
+            for (size_type i = begin; i < end; i++) {
+              k_out[unravel(i, strides_out)] = result(
+                index.template reduce<T, Acc>(k_in, op, load, i, 0, n_red));
+            }
+          });
+        return;
+      }
+
+      const size_type chunk = gt::div_ceil(n_red, nchunks);
+      // rounding chunk up may leave trailing chunks empty
+      nchunks = gt::div_ceil(n_red, chunk);
+      std::vector<T> partial(n_out * nchunks);
+      gt::backend::host::parallel_for(
+        nchunks, 1, [&](size_type begin, size_type end) {
+          for (size_type c = begin; c < end; c++) {
+            size_type r_begin = c * chunk;
+            size_type r_end = std::min(n_red, r_begin + chunk);
+            for (size_type i = 0; i < n_out; i++) {
+              partial[c * n_out + i] = index.template reduce<T, Acc>(
+                k_in, op, load, i, r_begin, r_end);
+            }
+          }
+        });
+      for (size_type i = 0; i < n_out; i++) {
+        T acc = partial[i];
+        for (size_type c = 1; c < nchunks; c++) {
+          acc = op(acc, partial[c * n_out + i]);
+        }
+        k_out[unravel(i, strides_out)] = result(acc);
+      }
+    });
+  }
+};
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+template <>
+struct axis_reducer<space::device>
+{
+  template <typename T, typename Acc, typename KOut, typename KIn,
+            typename Index, typename Op, typename Load, typename Result>
+  static void run(KOut k_out, KIn k_in, Index index, Op op, Load load,
+                  Result result, size_type n_out, size_type n_red,
+                  gt::stream_view stream)
+  {
+    auto strides_out = index.strides_out;
+    size_type nchunks = std::min<size_type>(
+      gt::div_ceil(AXIS_REDUCE_DEVICE_PARALLELISM, n_out),
+      n_red / AXIS_REDUCE_MIN_CHUNK);
+
+    if (nchunks <= 1) {
+      gt::launch<1, space::device>(
+        gt::shape(static_cast<int>(n_out)),
+        GT_LAMBDA(int i) {
+          k_out[unravel(i, strides_out)] = result(
+            index.template reduce<T, Acc>(k_in, op, load, i, 0, n_red));
+        },
+        stream);
+      return;
+    }
+
+    const size_type chunk = gt::div_ceil(n_red, nchunks);
+    // rounding chunk up may leave trailing chunks empty
+    nchunks = gt::div_ceil(n_red, chunk);
+    // freeing partial is ordered after the kernels on stream
+    gt::deallocation_stream ds(stream);
+    gt::gtensor<T, 2, space::device> partial(
+      gt::shape(static_cast<int>(n_out), static_cast<int>(nchunks)));
+    auto k_partial = partial.to_kernel();
+    gt::launch<2, space::device>(
+      partial.shape(),
+      GT_LAMBDA(int i, int c) {
+        size_type r_begin = c * chunk;
+        size_type r_end = r_begin + chunk < n_red ? r_begin + chunk : n_red;
+        k_partial(i, c) =
+          index.template reduce<T, Acc>(k_in, op, load, i, r_begin, r_end);
+      },
+      stream);
+    gt::launch<1, space::device>(
+      gt::shape(static_cast<int>(n_out)),
+      GT_LAMBDA(int i) {
+        T acc = k_partial(i, 0);
+        for (size_type c = 1; c < nchunks; c++) {
+          acc = op(acc, k_partial(i, c));
+        }
+        k_out[unravel(i, strides_out)] = result(acc);
+      },
+      stream);
+  }
+};
+
+#endif // GTENSOR_HAVE_DEVICE
+
+// reduce in over axes into out, accumulating load(in[idx]) as T through the
+// accumulator type Acc and storing result(acc)
+template <typename T, typename Acc, typename Eout, typename Ein, size_type M,
+          typename Op, typename Load, typename Result>
+inline void accumulate_axis_to(Eout&& out, Ein&& in, gt::sarray<int, M> axes,
+                               Op op, Load load, Result result,
+                               gt::stream_view stream)
+{
+  using Sout = expr_space_type<Eout>;
+  using Sin = expr_space_type<Ein>;
+
+  static_assert(std::is_same<Sout, Sin>::value,
+                "out and in expressions must be in the same space");
+
+  constexpr auto dims_out = expr_dimension<Eout>();
+  constexpr auto dims_in = expr_dimension<Ein>();
+
+  static_assert(dims_out == dims_in - M,
+                "out expression must have one dimension less than in "
+                "expression for each reduced axis");
+
+  std::sort(axes.begin(), axes.end());
+  assert(std::adjacent_find(axes.begin(), axes.end()) == axes.end());
+  assert(M == 0 || (axes[0] >= 0 && axes[M - 1] < int(dims_in)));
+
+  auto shape_in = in.shape();
+  auto shape_out = out.shape();
+
+  detail::axis_reduction_index<dims_in, M> index;
+  index.axes = axes;
+  size_type n_red = 1;
+  for (size_type m = 0; m < M; m++) {
+    index.shape_red[m] = shape_in[axes[m]];
+    n_red *= shape_in[axes[m]];
+  }
+  for (int d = 0, d_out = 0, m = 0; d < int(dims_in); d++) {
+    if (m < int(M) && axes[m] == d) {
+      m++;
+    } else {
+      assert(shape_out[d_out] == shape_in[d]);
+      index.kept[d_out++] = d;
+    }
+  }
+  // Note: use logical indexing strides, not internal strides which may be
+  // for addressing the underlying data for gview
+  index.strides_out = calc_strides(shape_out);
+
+  const size_type n_out = calc_size(shape_out);
+  if (n_out == 0) {
+    return;
+  }
+  assert(n_red > 0);
+
+  axis_reducer<Sout>::template run<T, Acc>(out.to_kernel(), in.to_kernel(),
+                                           index, op, load, result, n_out,
+                                           n_red, stream);
+}
+
+} // namespace detail
+
+template <typename Eout, typename Ein, size_type M, typename Op>
+inline void reduce_axis_to(Eout&& out, Ein&& in, gt::sarray<int, M> axes,
+                           Op op, gt::stream_view stream = gt::stream_view{})
+{
+  using Tout = expr_value_type<Eout>;
+  using Tin = expr_value_type<Ein>;
+
+  static_assert(std::is_same<Tout, Tin>::value,
+                "out and in expressions must have the same value type");
+
+  detail::accumulate_axis_to<Tout, detail::serial_accumulator<Tout, Op>>(
+    std::forward<Eout>(out), std::forward<Ein>(in), axes, op,
+    detail::UnaryOpIdentity<Tout>{}, detail::UnaryOpIdentity<Tout>{}, stream);
+}
+
+template <typename Eout, typename Ein, typename Op>
+inline void reduce_axis_to(Eout&& out, Ein&& in, int axis, Op op,
+                           gt::stream_view stream = gt::stream_view{})
+{
+  reduce_axis_to(std::forward<Eout>(out), std::forward<Ein>(in),
+                 gt::sarray<int, 1>{axis}, op, stream);
+}
+
+#define MAKE_AXIS_REDUCTION(NAME, OP)                                          \
+  template <typename Eout, typename Ein, typename Axes>                        \
+  inline void NAME(Eout&& out, Ein&& in, Axes axes,                            \
+                   gt::stream_view stream = gt::stream_view{})                 \
+  {                                                                            \
+    reduce_axis_to(std::forward<Eout>(out), std::forward<Ein>(in), axes, OP,   \
+                   stream);                                                    \
+  }
+
+MAKE_AXIS_REDUCTION(sum_axis_to, gt::ops::plus{})
+MAKE_AXIS_REDUCTION(prod_axis_to, gt::ops::multiply{})
+MAKE_AXIS_REDUCTION(max_axis_to, detail::BinaryOpMax{})
+MAKE_AXIS_REDUCTION(min_axis_to, detail::BinaryOpMin{})
+
+#undef MAKE_AXIS_REDUCTION
+
+template <typename E>
+auto norm_linf(const E& e, gt::stream_view stream = gt::stream_view{})
+{
+  return gt::max(gt::abs(e), stream);
+}
+
+namespace detail
+{
+
+template <typename Tin, typename Tout = Tin, typename Enable = void>
+struct UnaryOpNorm
+{
+  GT_INLINE Tout operator()(Tin a) const { return a * a; }
+};
+
+template <typename Tin, typename Tout>
+struct UnaryOpNorm<Tin, Tout,
+                   gt::meta::void_t<std::enable_if_t<gt::is_complex_v<Tin>>>>
+{
+  GT_INLINE Tout operator()(Tin a) const { return gt::norm(a); }
+};
+
+} // namespace detail
+
+/*! Reduction helper implementing sum of squares on arbitrary expressions. For
+ * complex valued arrays, uses `gt::norm` instead of square, so it calculates
+ * the L2 norm squared. Expressions are evaluated on the fly inside the
+ * reduction.
+ */
+template <typename E>
+auto sum_squares(const E& e, gt::stream_view stream = gt::stream_view{})
+{
+  using ValueType = expr_value_type<E>;
+  using Real = gt::complex_subtype_t<ValueType>;
+  return gt::transform_reduce(e, 0.0, std::plus<>{},
+                              detail::UnaryOpNorm<ValueType, Real>{}, stream);
+}
+
+// ======================================================================
+// summation policies
+//
+// sum, reduce, sum_axis_to and sum_squares take an optional policy argument
+// that selects how values are accumulated, e.g. gt::sum(a, gt::summation::
+// kahan{}):
+//
+//   naive     accumulate as is, the default
+//   pairwise  on host, partial sums of short pieces are combined pairwise, so
+//             the rounding error grows with log(n) rather than n
+//   kahan     compensated summation, which carries along the rounding error
+//             of every addition (op must be a plus)
+//   widened   accumulate float and complex<float> values in double precision
+//
+// Device reductions already combine their partial results in a tree, so
+// pairwise is the same as naive there. The result has the same type as
+// without a policy. Compensated summation relies on IEEE rounding and does
+// not survive -ffast-math.
+
+namespace summation
+{
+
+struct naive
+{};
+
+struct pairwise
+{};
+
+struct kahan
+{};
+
+struct widened
+{};
+
+} // namespace summation
+
+namespace detail
+{
+
+template <typename P>
+struct is_summation_policy : std::false_type
+{};
+
+template <>
+struct is_summation_policy<summation::naive> : std::true_type
+{};
+
+template <>
+struct is_summation_policy<summation::pairwise> : std::true_type
+{};
+
+template <>
+struct is_summation_policy<summation::kahan> : std::true_type
+{};
+
+template <>
+struct is_summation_policy<summation::widened> : std::true_type
+{};
+
+template <typename P>
+using enable_if_summation_policy_t =
+  std::enable_if_t<is_summation_policy<P>::value, int>;
+
+template <typename Op>
+struct is_plus_op : std::false_type
+{};
+
+template <>
+struct is_plus_op<gt::ops::plus> : std::true_type
+{};
+
+template <typename T>
+struct is_plus_op<std::plus<T>> : std::true_type
+{};
+
+template <typename T>
+struct widened_type
+{
+  using type = T;
+};
+
+template <>
+struct widened_type<float>
+{
+  using type = double;
+};
+
+template <>
+struct widened_type<gt::complex<float>>
+{
+  using type = gt::complex<double>;
+};
+
+// a sum together with the rounding error accumulated while computing it
+template <typename T>
+struct compensated
+{
+  T sum;
+  T error;
+};
+
+// TwoSum gives the exact rounding error of a + b without branches, so this is
+// Neumaier's variant of Kahan summation, which stays accurate when an addend
+// is larger than the running sum, and it vectorizes across accumulators
+struct compensated_plus
+{
+  template <typename T>
+  GT_INLINE compensated<T> operator()(const compensated<T>& a,
+                                      const compensated<T>& b) const
+  {
+    T sum = a.sum + b.sum;
+    T b_virtual = sum - a.sum;
+    T a_virtual = sum - b_virtual;
+    T error = (a.sum - a_virtual) + (b.sum - b_virtual);
+    return {sum, a.error + b.error + error};
+  }
+};
+
+// How the policy P reduces values of type T with op: values are loaded into
+// acc_type, combined with op_type, partial results of pieces are combined by
+// accumulator, and result converts back to T.
+template <typename P, typename T, typename Op>
+struct summation_traits
+{
+  using acc_type = T;
+  using op_type = Op;
+  using accumulator = serial_accumulator<acc_type, op_type>;
+
+  static op_type make_op(Op op) { return op; }
+  GT_INLINE static acc_type load(const T& value) { return value; }
+  GT_INLINE static T result(const acc_type& acc) { return acc; }
+};
+
+template <typename T, typename Op>
+struct summation_traits<summation::pairwise, T, Op>
+  : summation_traits<summation::naive, T, Op>
+{
+  using accumulator = pairwise_accumulator<T, Op>;
+};
+
+template <typename T, typename Op>
+struct summation_traits<summation::widened, T, Op>
+{
+  using acc_type = typename widened_type<T>::type;
+  using op_type = Op;
+  using accumulator = serial_accumulator<acc_type, op_type>;
+
+  static op_type make_op(Op op) { return op; }
+  GT_INLINE static acc_type load(const T& value) { return value; }
+  GT_INLINE static T result(const acc_type& acc) { return T(acc); }
+};
+
+template <typename T, typename Op>
+struct summation_traits<summation::kahan, T, Op>
+{
+  static_assert(is_plus_op<Op>::value,
+                "compensated summation requires a plus reduction op");
+
+  using acc_type = compensated<T>;
+  using op_type = compensated_plus;
+  using accumulator = serial_accumulator<acc_type, op_type>;
+
+  static op_type make_op(Op op) { return {}; }
+  GT_INLINE static acc_type load(const T& value) { return {value, T(0)}; }
+  GT_INLINE static T result(const acc_type& acc) { return acc.sum + acc.error; }
+};
+
+template <typename Traits, typename Transform>
+struct summation_load
+{
+  Transform transform;
+
+  template <typename V>
+  GT_INLINE typename Traits::acc_type operator()(const V& value) const
+  {
+    return Traits::load(transform(value));
+  }
+};
+
+template <typename Traits>
+struct summation_result
+{
+  GT_INLINE auto operator()(const typename Traits::acc_type& acc) const
+  {
+    return Traits::result(acc);
+  }
+};
+
+// op(init, transform(e[0]), ...) as T, accumulated according to the policy P
+template <typename T, typename P, typename E, typename Op, typename Transform,
+          std::enable_if_t<is_host_reducible<E>::value, int> = 0>
+inline T policy_reduce(const E& e, T init, Op op, Transform transform,
+                       gt::stream_view stream)
+{
+  using traits = summation_traits<P, T, Op>;
+  using acc_type = typename traits::acc_type;
+
+  gt::detail::host_stream_wait(stream);
+  if (calc_size(e.shape()) == 0) {
+    return init;
+  }
+  auto acc_op = traits::make_op(op);
+  acc_type acc =
+    host_accumulate_expression<acc_type, typename traits::accumulator>(
+      e, acc_op,
+      value_transform<summation_load<traits, Transform>>{{transform}});
+  return traits::result(acc_op(traits::load(init), acc));
+}
+
+template <typename T, typename P, typename E, typename Op, typename Transform,
+          std::enable_if_t<!is_host_reducible<E>::value, int> = 0>
+inline T policy_reduce(const E& e, T init, Op op, Transform transform,
+                       gt::stream_view stream)
+{
+  using traits = summation_traits<P, T, Op>;
+  return traits::result(gt::transform_reduce(
+    e, traits::load(init), traits::make_op(op),
+    summation_load<traits, Transform>{transform}, stream));
+}
+
+} // namespace detail
+
+template <typename E, typename Policy,
+          detail::enable_if_summation_policy_t<Policy> = 0>
+inline auto sum(const E& e, Policy policy,
+                gt::stream_view stream = gt::stream_view{})
+{
+  using T = expr_value_type<E>;
+  return detail::policy_reduce<T, Policy>(e, T(0), gt::ops::plus{},
+                                          detail::UnaryOpIdentity<T>{}, stream);
+}
+
+template <typename E, typename OutputType, typename BinaryReductionOp,
+          typename Policy, detail::enable_if_summation_policy_t<Policy> = 0>
+inline OutputType reduce(const E& e, OutputType init,
+                         BinaryReductionOp reduction_op, Policy policy,
+                         gt::stream_view stream = gt::stream_view{})
+{
+  return detail::policy_reduce<OutputType, Policy>(
+    e, init, reduction_op, detail::UnaryOpIdentity<OutputType>{}, stream);
+}
+
+/*! Sum of squares with a summation policy. Like without a policy, the result
+ * is always accumulated in (at least) double precision.
+ */
+template <typename E, typename Policy,
+          detail::enable_if_summation_policy_t<Policy> = 0>
+auto sum_squares(const E& e, Policy policy,
+                 gt::stream_view stream = gt::stream_view{})
+{
+  using ValueType = expr_value_type<E>;
+  using Real = gt::complex_subtype_t<ValueType>;
+  return detail::policy_reduce<double, Policy>(
+    e, 0.0, gt::ops::plus{}, detail::UnaryOpNorm<ValueType, Real>{}, stream);
+}
+
+template <typename Eout, typename Ein, size_type M, typename Policy,
+          detail::enable_if_summation_policy_t<Policy> = 0>
+inline void sum_axis_to(Eout&& out, Ein&& in, gt::sarray<int, M> axes,
+                        Policy policy,
+                        gt::stream_view stream = gt::stream_view{})
+{
+  using T = expr_value_type<Eout>;
+  using traits = detail::summation_traits<Policy, T, gt::ops::plus>;
+  detail::accumulate_axis_to<typename traits::acc_type,
+                             typename traits::accumulator>(
+    std::forward<Eout>(out), std::forward<Ein>(in), axes,
+    traits::make_op(gt::ops::plus{}),
+    detail::summation_load<traits, detail::UnaryOpIdentity<T>>{},
+    detail::summation_result<traits>{}, stream);
+}
+
+template <typename Eout, typename Ein, typename Policy,
+          detail::enable_if_summation_policy_t<Policy> = 0>
+inline void sum_axis_to(Eout&& out, Ein&& in, int axis, Policy policy,
+                        gt::stream_view stream = gt::stream_view{})
+{
+  sum_axis_to(std::forward<Eout>(out), std::forward<Ein>(in),
+              gt::sarray<int, 1>{axis}, policy, stream);
+}
+
+// ======================================================================
+// reduce_many
+//
+// Computes several reductions of the same expression in a single traversal,
+// e.g.
+//
+//   double sum, max_abs, sum_sq;
+//   std::tie(sum, max_abs, sum_sq) = gt::reduce_many(
+//     e, gt::reducers::sum{}, gt::reducers::max_abs{},
+//     gt::reducers::sum_squares{});
+//
+// Besides the predefined reducers, gt::make_reducer(init, op, transform)
+// describes a general transform_reduce. The accumulators of all reducers are
+// carried together through the host or device reduction kernels.
+
+template <typename T, typename Op, typename Transform>
+struct reducer
+{
+  using value_type = T;
+
+  T init;
+  Op op;
+  Transform transform;
+};
+
+template <typename T, typename Op,
+          typename Transform = detail::UnaryOpIdentity<T>>
+inline auto make_reducer(T init, Op op, Transform transform = Transform{})
+{
+  return reducer<T, Op, Transform>{init, op, transform};
+}
+
+namespace reducers
+{
+
+struct sum
+{};
+
+struct max
+{};
+
+struct min
+{};
+
+struct max_abs
+{};
+
+struct sum_squares
+{};
+
+} // namespace reducers
+
+namespace detail
+{
+
+// bind a predefined reducer to the value type V of the expression
+
+template <typename V, typename T, typename Op, typename Transform>
+inline auto bind_reducer(const reducer<T, Op, Transform>& r)
+{
+  return r;
+}
+
+template <typename V>
+inline auto bind_reducer(reducers::sum)
+{
+  return make_reducer(V(0), gt::ops::plus{});
+}
+
+template <typename V>
+inline auto bind_reducer(reducers::max)
+{
+  return make_reducer(std::numeric_limits<V>::lowest(), BinaryOpMax{});
+}
+
+template <typename V>
+inline auto bind_reducer(reducers::min)
+{
+  return make_reducer(std::numeric_limits<V>::max(), BinaryOpMin{});
+}
+
+template <typename V>
+inline auto bind_reducer(reducers::max_abs)
+{
+  using Real = gt::complex_subtype_t<V>;
+  return make_reducer(Real(0), BinaryOpMax{}, gt::funcs::abs{});
+}
+
+template <typename V>
+inline auto bind_reducer(reducers::sum_squares)
+{
+  using Real = gt::complex_subtype_t<V>;
+  return make_reducer(Real(0), gt::ops::plus{}, UnaryOpNorm<V, Real>{});
+}
+
+// accumulators of a list of reducers, as a device friendly cons list
+struct reduce_nil
+{};
+
+template <typename H, typename T>
+struct reduce_cons
+{
+  H head;
+  T tail;
+};
+
+template <typename... Rs>
+struct reducer_list;
+
+template <>
+struct reducer_list<>
+{
+  using value_type = reduce_nil;
+
+  GT_INLINE value_type init() const { return {}; }
+
+  template <typename V>
+  GT_INLINE value_type transform(const V&) const
+  {
+    return {};
+  }
+
+  GT_INLINE value_type combine(const value_type&, const value_type&) const
+  {
+    return {};
+  }
+
+  std::tuple<> to_tuple(const value_type&) const { return {}; }
+};
+
+template <typename R, typename... Rs>
+struct reducer_list<R, Rs...>
+{
+  using tail_type = reducer_list<Rs...>;
+  using value_type =
+    reduce_cons<typename R::value_type, typename tail_type::value_type>;
+
+  R head;
+  tail_type tail;
+
+  GT_INLINE value_type init() const { return {head.init, tail.init()}; }
+
+  template <typename V>
+  GT_INLINE value_type transform(const V& v) const
+  {
+    return {head.transform(v), tail.transform(v)};
+  }
+
+  GT_INLINE value_type combine(const value_type& a, const value_type& b) const
+  {
+    return {head.op(a.head, b.head), tail.combine(a.tail, b.tail)};
+  }
+
+  auto to_tuple(const value_type& v) const
+  {
+    return std::tuple_cat(std::make_tuple(v.head), tail.to_tuple(v.tail));
+  }
+};
+
+inline reducer_list<> make_reducer_list() { return {}; }
+
+template <typename R, typename... Rs>
+inline reducer_list<R, Rs...> make_reducer_list(R r, Rs... rs)
+{
+  return {r, make_reducer_list(rs...)};
+}
+
+template <typename List>
+struct reducer_list_combine
+{
+  List list;
+
+  template <typename T>
+  GT_INLINE T operator()(const T& a, const T& b) const
+  {
+    return list.combine(a, b);
+  }
+};
+
+template <typename List>
+struct reducer_list_transform
+{
+  List list;
+
+  template <typename V>
+  GT_INLINE auto operator()(const V& v) const
+  {
+    return list.transform(v);
+  }
+};
+
+} // namespace detail
+
+template <typename E, typename... Reducers>
+inline auto reduce_many(gt::stream_view stream, const E& e,
+                        Reducers... reducers)
+{
+  using V = expr_value_type<E>;
+  auto list = detail::make_reducer_list(detail::bind_reducer<V>(reducers)...);
+  using list_type = decltype(list);
+  auto result = gt::transform_reduce(
+    e, list.init(), detail::reducer_list_combine<list_type>{list},
+    detail::reducer_list_transform<list_type>{list}, stream);
+  return list.to_tuple(result);
+}
+
+template <typename E, typename... Reducers,
+          typename = std::enable_if_t<is_expression<E>::value>>
+inline auto reduce_many(const E& e, Reducers... reducers)
+{
+  return reduce_many(gt::stream_view{}, e, reducers...);
+}
+
+// ======================================================================
+// scans
+//
+// inclusive_scan and exclusive_scan write the running reduction of an
+// expression, taken in column major order, to a contiguous container with the
+// same number of elements. The _by_key variants restart the scan wherever the
+// key differs from the previous one. The op only needs to be associative.
+//
+// The input is split into blocks: the blocks are reduced in parallel, their
+// totals are scanned, and then each block is scanned in parallel starting
+// from the total of the blocks before it, which is about twice the work of a
+// serial scan. On host the block size is fixed, so results do not depend on
+// the number of threads.
+
+namespace detail
+{
+
+constexpr size_type HOST_SCAN_BLOCK = 16 * 1024;
+constexpr size_type DEVICE_SCAN_MIN_CHUNK = 64;
+constexpr size_type DEVICE_SCAN_PARALLELISM = 64 * 1024;
+
+// element i of a contiguous container kernel
+template <typename T, typename K>
+struct flat_data_load
+{
+  K k;
+
+  GT_INLINE T operator()(size_type i) const { return k.data_access(i); }
+};
+
+template <typename K>
+struct flat_data_store
+{
+  K k;
+
+  template <typename T>
+  GT_INLINE void operator()(size_type i, const T& value) const
+  {
+    k.data_access(i) = value;
+  }
+};
+
+template <typename T, typename E>
+inline auto make_flat_load(const E& e, std::true_type)
+{
+  auto k = e.to_kernel();
+  return flat_data_load<T, decltype(k)>{k};
+}
+
+template <typename T, typename E>
+inline auto make_flat_load(const E& e, std::false_type)
+{
+  return make_flat_expression_transform(e, UnaryOpIdentity<T>{});
+}
+
+template <typename T, typename E>
+inline auto make_flat_load(const E& e)
+{
+  using contiguous = std::integral_constant<bool, has_data_method_v<E>>;
+  return make_flat_load<T>(e, contiguous{});
+}
+
+// reduce load(i) over the non-empty range [begin, end) in order
+template <typename T, typename Load, typename Op>
+GT_INLINE T scan_fold_range(size_type begin, size_type end, const Load& load,
+                            const Op& op)
+{
+  T local = load(begin);
+  for (size_type i = begin + 1; i < end; i++) {
+    local = op(local, load(i));
+  }
+  return local;
+}
+
+// scan load(i) over the non-empty range [begin, end) into store, combined on
+// the left with carry if has_carry (always the case for exclusive scans).
+// Each element is loaded before the same element is stored, so in and out may
+// be the same container. Returns the same value as scan_fold_range.
+template <typename T, typename Load, typename Store, typename Op>
+GT_INLINE T scan_range(size_type begin, size_type end, bool exclusive,
+                       bool has_carry, const T& carry, const Load& load,
+                       const Store& store, const Op& op)
+{
+  T local = load(begin);
+  if (exclusive) {
+    store(begin, carry);
+    for (size_type i = begin + 1; i < end; i++) {
+      T value = load(i);
+      store(i, T(op(carry, local)));
+      local = op(local, value);
+    }
+  } else if (has_carry) {
+    store(begin, T(op(carry, local)));
+    for (size_type i = begin + 1; i < end; i++) {
+      local = op(local, load(i));
+      store(i, T(op(carry, local)));
+    }
+  } else {
+    store(begin, local);
+    for (size_type i = begin + 1; i < end; i++) {
+      local = op(local, load(i));
+      store(i, local);
+    }
+  }
+  return local;
+}
+
+// segmented scans are plain scans over (head, value) pairs, where head marks
+// the first element of a segment
+template <typename T>
+struct segment_value
+{
+  bool head;
+  T value;
+};
+
+template <typename Op>
+struct segment_op
+{
+  Op op;
+
+  template <typename T>
+  GT_INLINE segment_value<T> operator()(const segment_value<T>& a,
+                                        const segment_value<T>& b) const
+  {
+    return {a.head || b.head, b.head ? b.value : T(op(a.value, b.value))};
+  }
+};
+
+// For exclusive scans, the value at i is the input at i - 1, or init at the
+// head of a segment, so the inclusive scan of these gives the exclusive scan.
+// That reads past the element being stored, so in and out must not overlap.
+template <typename T, typename KeyLoad, typename Load>
+struct segment_load
+{
+  KeyLoad keys;
+  Load load;
+  bool exclusive;
+  T init;
+
+  GT_INLINE segment_value<T> operator()(size_type i) const
+  {
+    bool head = i == 0 || !(keys(i) == keys(i - 1));
+    if (!exclusive) {
+      return {head, load(i)};
+    }
+    return {head, head ? init : T(load(i - 1))};
+  }
+};
+
+template <typename Store>
+struct segment_store
+{
+  Store store;
+
+  template <typename T>
+  GT_INLINE void operator()(size_type i, const segment_value<T>& v) const
+  {
+    store(i, v.value);
+  }
+};
+
+template <typename S>
+struct scanner;
+
+template <>
+struct scanner<space::host>
+{
+  template <typename T, typename Load, typename Store, typename Op>
+  static void run(size_type n, Load load, Store store, Op op, bool exclusive,
+                  bool has_init, T init, gt::stream_view stream)
+  {
+    gt::detail::host_stream_submit(stream, [=]() {
+      const size_type nblocks = gt::div_ceil(n, HOST_SCAN_BLOCK);
+      auto block_end = [&](size_type b) {
+        return std::min(n, (b + 1) * HOST_SCAN_BLOCK);
+      };
+
+      // a single pass gives the same result as the parallel passes, since
+      // the total returned for each block is the same
+      if (nblocks == 1 || gt::backend::host::get_num_threads() == 1) {
+        bool has_carry = has_init;
+        T carry = init;
+        for (size_type b = 0; b < nblocks; b++) {
+          T total = scan_range<T>(b * HOST_SCAN_BLOCK, block_end(b), exclusive,
+                                  has_carry, carry, load, store, op);
+          carry = has_carry ? T(op(carry, total)) : total;
+          has_carry = true;
+        }
+        return;
+      }
+
+      std::vector<T> carry(nblocks);
+      gt::backend::host::parallel_for(
+        nblocks, 1, [&](size_type begin, size_type end) {
+          for (size_type b = begin; b < end; b++) {
+            carry[b] = scan_fold_range<T>(b * HOST_SCAN_BLOCK, block_end(b),
+                                          load, op);
+          }
+        });
+      T acc = init;
+      for (size_type b = 0; b < nblocks; b++) {
+        T total = carry[b];
+        carry[b] = acc;
+        acc = (has_init || b > 0) ? T(op(acc, total)) : total;
+      }
+      gt::backend::host::parallel_for(
+        nblocks, 1, [&](size_type begin, size_type end) {
+          for (size_type b = begin; b < end; b++) {
+            scan_range<T>(b * HOST_SCAN_BLOCK, block_end(b), exclusive,
+                          has_init || b > 0, carry[b], load, store, op);
+          }
+        });
+    });
+  }
+};
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+template <>
+struct scanner<space::device>
+{
+  template <typename T, typename Load, typename Store, typename Op>
+  static void run(size_type n, Load load, Store store, Op op, bool exclusive,
+                  bool has_init, T init, gt::stream_view stream)
+  {
+    const size_type chunk = gt::div_ceil(
+      n, std::min(DEVICE_SCAN_PARALLELISM,
+                  gt::div_ceil(n, DEVICE_SCAN_MIN_CHUNK)));
+    const size_type nblocks = gt::div_ceil(n, chunk);
+
+    if (nblocks == 1) {
+      gt::launch<1, space::device>(
+        gt::shape(1),
+        GT_LAMBDA(int) {
+          scan_range<T>(0, n, exclusive, has_init, init, load, store, op);
+        },
+        stream);
+      return;
+    }
+
+    // freeing carry is ordered after the kernels on stream
+    gt::deallocation_stream ds(stream);
+    gt::gtensor<T, 1, space::device> carry(
+      gt::shape(static_cast<int>(nblocks)));
+    auto k_carry = carry.to_kernel();
+    gt::launch<1, space::device>(
+      carry.shape(),
+      GT_LAMBDA(int b) {
+        size_type end = (b + 1) * chunk < n ? (b + 1) * chunk : n;
+        k_carry(b) = scan_fold_range<T>(b * chunk, end, load, op);
+      },
+      stream);
+    // carry(b) becomes the total of the blocks up to and including b
+    run<T>(nblocks, flat_data_load<T, decltype(k_carry)>{k_carry},
+           flat_data_store<decltype(k_carry)>{k_carry}, op, false, has_init,
+           init, stream);
+    gt::launch<1, space::device>(
+      carry.shape(),
+      GT_LAMBDA(int b) {
+        size_type end = (b + 1) * chunk < n ? (b + 1) * chunk : n;
+        T c = b > 0 ? T(k_carry(b - 1)) : init;
+        scan_range<T>(b * chunk, end, exclusive, has_init || b > 0, c, load,
+                      store, op);
+      },
+      stream);
+  }
+};
+
+#endif // GTENSOR_HAVE_DEVICE
+
+template <typename Ein, typename Eout>
+inline size_type scan_size(const Ein& in, const Eout& out)
+{
+  using Sout = expr_space_type<Eout>;
+  using Sin = expr_space_type<Ein>;
+
+  static_assert(std::is_same<Sout, Sin>::value ||
+                  std::is_same<Sin, space::any>::value,
+                "out and in expressions must be in the same space");
+  static_assert(has_data_method_v<std::decay_t<Eout>>,
+                "scan output must be a contiguous container");
+
+  assert(calc_size(in.shape()) == calc_size(out.shape()));
+  return calc_size(out.shape());
+}
+
+template <typename Ein, typename Eout, typename T, typename Op>
+inline void scan(const Ein& in, Eout& out, bool exclusive, bool has_init,
+                 T init, Op op, gt::stream_view stream)
+{
+  const size_type n = scan_size(in, out);
+  if (n == 0) {
+    return;
+  }
+  auto k_out = out.to_kernel();
+  scanner<expr_space_type<Eout>>::template run<T>(
+    n, make_flat_load<T>(in), flat_data_store<decltype(k_out)>{k_out}, op,
+    exclusive, has_init, init, stream);
+}
+
+template <typename Ekeys, typename Ein, typename Eout, typename T,
+          typename Op>
+inline void scan_by_key(const Ekeys& keys, const Ein& in, Eout& out,
+                        bool exclusive, T init, Op op, gt::stream_view stream)
+{
+  const size_type n = scan_size(in, out);
+  assert(calc_size(keys.shape()) == n);
+  if (n == 0) {
+    return;
+  }
+  using K = expr_value_type<Ekeys>;
+  auto load_keys = make_flat_load<K>(keys);
+  auto load = make_flat_load<T>(in);
+  auto k_out = out.to_kernel();
+  using store_type = flat_data_store<decltype(k_out)>;
+  scanner<expr_space_type<Eout>>::template run<segment_value<T>>(
+    n,
+    segment_load<T, decltype(load_keys), decltype(load)>{load_keys, load,
+                                                         exclusive, init},
+    segment_store<store_type>{store_type{k_out}}, segment_op<Op>{op}, false,
+    false, segment_value<T>{}, stream);
+}
+
+template <typename Op>
+using enable_if_scan_op_t =
+  std::enable_if_t<!std::is_convertible<Op, gt::stream_view>::value, int>;
+
+} // namespace detail
+
+/*! Write the running reductions in[0], op(in[0], in[1]), ... of the elements
+ * of in, in column major order, to the contiguous container out.
+ */
+template <typename Ein, typename Eout, typename Op,
+          detail::enable_if_scan_op_t<Op> = 0>
+inline void inclusive_scan(const Ein& in, Eout&& out, Op op,
+                           gt::stream_view stream = gt::stream_view{})
+{
+  using T = expr_value_type<Eout>;
+  detail::scan(in, out, false, false, T{}, op, stream);
+}
+
+template <typename Ein, typename Eout>
+inline void inclusive_scan(const Ein& in, Eout&& out,
+                           gt::stream_view stream = gt::stream_view{})
+{
+  gt::inclusive_scan(in, out, gt::ops::plus{}, stream);
+}
+
+/*! Write init, op(init, in[0]), ... to out, leaving out the last element of
+ * in.
+ */
+template <typename Ein, typename Eout, typename Op,
+          detail::enable_if_scan_op_t<Op> = 0>
+inline void exclusive_scan(const Ein& in, Eout&& out,
+                           expr_value_type<Eout> init, Op op,
+                           gt::stream_view stream = gt::stream_view{})
+{
+  detail::scan(in, out, true, true, init, op, stream);
+}
+
+template <typename Ein, typename Eout>
+inline void exclusive_scan(const Ein& in, Eout&& out,
+                           expr_value_type<Eout> init,
+                           gt::stream_view stream = gt::stream_view{})
+{
+  gt::exclusive_scan(in, out, init, gt::ops::plus{}, stream);
+}
+
+/*! Inclusive scan that restarts at every element whose key differs from the
+ * previous key. out must not overlap keys.
+ */
+template <typename Ekeys, typename Ein, typename Eout, typename Op,
+          detail::enable_if_scan_op_t<Op> = 0>
+inline void inclusive_scan_by_key(const Ekeys& keys, const Ein& in,
+                                  Eout&& out, Op op,
+                                  gt::stream_view stream = gt::stream_view{})
+{
+  using T = expr_value_type<Eout>;
+  detail::scan_by_key(keys, in, out, false, T{}, op, stream);
+}
+
+template <typename Ekeys, typename Ein, typename Eout>
+inline void inclusive_scan_by_key(const Ekeys& keys, const Ein& in,
+                                  Eout&& out,
+                                  gt::stream_view stream = gt::stream_view{})
+{
+  gt::inclusive_scan_by_key(keys, in, out, gt::ops::plus{}, stream);
+}
+
+/*! Exclusive scan that restarts from init at every element whose key differs
+ * from the previous key. out must not overlap keys or in.
+ */
+template <typename Ekeys, typename Ein, typename Eout, typename Op,
+          detail::enable_if_scan_op_t<Op> = 0>
+inline void exclusive_scan_by_key(const Ekeys& keys, const Ein& in,
+                                  Eout&& out, expr_value_type<Eout> init,
+                                  Op op,
+                                  gt::stream_view stream = gt::stream_view{})
+{
+  detail::scan_by_key(keys, in, out, true, init, op, stream);
+}
+
+template <typename Ekeys, typename Ein, typename Eout>
+inline void exclusive_scan_by_key(const Ekeys& keys, const Ein& in,
+                                  Eout&& out, expr_value_type<Eout> init,
+                                  gt::stream_view stream = gt::stream_view{})
+{
+  gt::exclusive_scan_by_key(keys, in, out, init, gt::ops::plus{}, stream);
+}
+
+// ======================================================================
+// index reductions
+//
+// argmax and argmin return the extreme value of an expression together with
+// its column major flat index and the corresponding multi-index; ties go to
+// the smallest index. argmax_axis_to and argmin_axis_to write, for each
+// element of out, the index of the extreme value within the reduced axes.
+// top_k returns the k largest values, best first.
+//
+// On device, values are paired with their flat index by a generator
+// expression, so the pairs can go through the regular device reductions.
+
+template <typename T, size_type N>
+struct arg_result
+{
+  T value;
+  size_type index;
+  gt::shape_type<N> multi_index;
+};
+
+namespace detail
+{
+
+template <typename T>
+struct arg_value
+{
+  T value;
+  size_type index;
+};
+
+struct make_arg_value
+{
+  template <typename T>
+  GT_INLINE arg_value<T> operator()(T value, size_type index) const
+  {
+    return {value, index};
+  }
+};
+
+// whether a comes before b in descending order of value, then index
+struct arg_value_greater
+{
+  template <typename T>
+  GT_INLINE bool operator()(const arg_value<T>& a,
+                            const arg_value<T>& b) const
+  {
+    return a.value > b.value || (a.value == b.value && a.index < b.index);
+  }
+};
+
+struct arg_value_less
+{
+  template <typename T>
+  GT_INLINE bool operator()(const arg_value<T>& a,
+                            const arg_value<T>& b) const
+  {
+    return a.value < b.value || (a.value == b.value && a.index < b.index);
+  }
+};
+
+template <typename Before>
+struct BinaryOpArg
+{
+  template <typename T>
+  GT_INLINE arg_value<T> operator()(const arg_value<T>& a,
+                                    const arg_value<T>& b) const
+  {
+    return Before{}(b, a) ? b : a;
+  }
+};
+
+using BinaryOpArgMax = BinaryOpArg<arg_value_greater>;
+using BinaryOpArgMin = BinaryOpArg<arg_value_less>;
+
+// sum of idx[d] * strides[d] for the multi-index it is called with
+template <size_type N>
+struct flat_index_generator
+{
+  gt::shape_type<N> strides;
+
+  template <typename... Args>
+  GT_INLINE size_type operator()(Args... args) const
+  {
+    const int idx[] = {int(args)...};
+    size_type flat = 0;
+    for (size_type d = 0; d < N; d++) {
+      flat += size_type(idx[d]) * strides[d];
+    }
+    return flat;
+  }
+};
+
+template <typename E, typename Strides>
+inline auto make_arg_values(E&& e, const Strides& strides)
+{
+  constexpr size_type N = expr_dimension<E>();
+  return gt::function(make_arg_value{}, std::forward<E>(e),
+                      gt::generator<N, size_type>(
+                        e.shape(), flat_index_generator<N>{strides}));
+}
+
+// on host, values are paired with the flat index the reduction walks them at
+template <typename T, typename E, typename Op, typename Strides>
+inline arg_value<T> arg_reduce_impl(const E& e, Op op, T, const Strides&,
+                                    gt::stream_view stream, std::true_type)
+{
+  gt::detail::host_stream_wait(stream);
+  return host_accumulate_expression<arg_value<T>,
+                                    serial_accumulator<arg_value<T>, Op>>(
+    e, op, make_arg_value{});
+}
+
+template <typename T, typename E, typename Op, typename Strides>
+inline arg_value<T> arg_reduce_impl(const E& e, Op op, T worst,
+                                    const Strides& strides,
+                                    gt::stream_view stream, std::false_type)
+{
+  arg_value<T> init{worst, std::numeric_limits<size_type>::max()};
+  return gt::transform_reduce(make_arg_values(e, strides), init, op,
+                              UnaryOpIdentity<arg_value<T>>{}, stream);
+}
+
+template <typename E, typename Op>
+inline auto arg_reduce(const E& e, Op op, expr_value_type<E> worst,
+                       gt::stream_view stream)
+{
+  using T = std::decay_t<expr_value_type<E>>;
+  constexpr size_type N = expr_dimension<E>();
+
+  const auto strides = calc_strides(e.shape());
+  assert(calc_size(e.shape()) > 0);
+  auto best = arg_reduce_impl<T>(e, op, worst, strides, stream,
+                                 is_host_reducible<E>{});
+  return arg_result<T, N>{best.value, best.index,
+                          unravel(best.index, strides)};
+}
+
+struct arg_value_index
+{
+  template <typename T>
+  GT_INLINE size_type operator()(const arg_value<T>& v) const
+  {
+    return v.index;
+  }
+};
+
+template <typename Op, typename Eout, typename Ein, size_type M>
+inline void arg_reduce_axis_to(Eout&& out, Ein&& in, gt::sarray<int, M> axes,
+                               gt::stream_view stream)
+{
+  using T = std::decay_t<expr_value_type<Ein>>;
+  using V = arg_value<T>;
+
+  static_assert(std::is_integral<expr_value_type<Eout>>::value,
+                "out expression must hold integer indices");
+
+  std::sort(axes.begin(), axes.end());
+  const expr_shape_type<Ein> shape = in.shape();
+  expr_shape_type<Ein> strides;
+  for (int d = 0; d < int(shape.size()); d++) {
+    strides[d] = 0;
+  }
+  for (int m = 0, stride = 1; m < int(M); m++) {
+    strides[axes[m]] = stride;
+    stride *= shape[axes[m]];
+  }
+
+  accumulate_axis_to<V, serial_accumulator<V, Op>>(
+    std::forward<Eout>(out), make_arg_values(std::forward<Ein>(in), strides),
+    axes, Op{}, UnaryOpIdentity<V>{}, arg_value_index{}, stream);
+}
+
+template <typename T, size_type N, typename E>
+inline std::vector<arg_result<T, N>> top_k_results(
+  std::vector<arg_value<T>>& best, size_type k, const E& e)
+{
+  std::sort(best.begin(), best.end(), arg_value_greater{});
+  if (best.size() > k) {
+    best.resize(k);
+  }
+  const auto strides = calc_strides(e.shape());
+  std::vector<arg_result<T, N>> result;
+  result.reserve(best.size());
+  for (const auto& v : best) {
+    result.push_back({v.value, v.index, unravel(v.index, strides)});
+  }
+  return result;
+}
+
+// Each worker keeps a heap of the best k values of its part of e, walked
+// along dimension 0, and the candidates are merged at the end.
+template <typename T, typename E>
+inline auto top_k_impl(const E& e, size_type k, gt::stream_view stream,
+                       std::true_type)
+{
+  using shape_type = expr_shape_type<E>;
+  using V = arg_value<T>;
+  constexpr size_type N = expr_dimension<E>();
+
+  if (k == 0) {
+    return std::vector<arg_result<T, N>>{};
+  }
+
+  gt::detail::host_stream_wait(stream);
+  const shape_type shape = e.shape();
+  const auto strides = calc_strides(shape);
+  const arg_value_greater before;
+
+  std::vector<V> best;
+  std::mutex best_mutex;
+  gt::backend::host::parallel_for(
+    calc_size(shape), HOST_REDUCE_BLOCK, [&](size_type begin, size_type end) {
+      std::vector<V> heap;
+      heap.reserve(k);
+      shape_type idx = unravel(begin, strides);
+      for (size_type i = begin; i < end; i++) {
+        V v{T(index_expression(e, idx)), i};
+        if (heap.size() < k) {
+          heap.push_back(v);
+          std::push_heap(heap.begin(), heap.end(), before);
+        } else if (before(v, heap.front())) {
+          std::pop_heap(heap.begin(), heap.end(), before);
+          heap.back() = v;
+          std::push_heap(heap.begin(), heap.end(), before);
+        }
+        for (int d = 0; d < int(N); d++) {
+          if (++idx[d] < shape[d]) {
+            break;
+          }
+          idx[d] = 0;
+        }
+      }
+      std::lock_guard<std::mutex> lock(best_mutex);
+      best.insert(best.end(), heap.begin(), heap.end());
+    });
+  return top_k_results<T, N>(best, k, e);
+}
+
+// unless first, values not after last in descending order are replaced by
+// worst, so that argmax finds the next value after last
+template <typename T>
+struct arg_value_after
+{
+  bool first;
+  arg_value<T> last;
+  arg_value<T> worst;
+
+  GT_INLINE arg_value<T> operator()(const arg_value<T>& v) const
+  {
+    return first || arg_value_greater{}(last, v) ? v : worst;
+  }
+};
+
+// one argmax per result, intended for small k
+template <typename T, typename E>
+inline auto top_k_impl(const E& e, size_type k, gt::stream_view stream,
+                       std::false_type)
+{
+  using V = arg_value<T>;
+  constexpr size_type N = expr_dimension<E>();
+
+  if (k == 0) {
+    return std::vector<arg_result<T, N>>{};
+  }
+
+  const auto strides = calc_strides(e.shape());
+  auto pairs = make_arg_values(e, strides);
+  const V worst{std::numeric_limits<T>::lowest(),
+                std::numeric_limits<size_type>::max()};
+  std::vector<V> best;
+  for (size_type j = 0; j < std::min(k, calc_size(e.shape())); j++) {
+    arg_value_after<T> after{j == 0, j > 0 ? best.back() : worst, worst};
+    best.push_back(
+      gt::transform_reduce(pairs, worst, BinaryOpArgMax{}, after, stream));
+  }
+  return top_k_results<T, N>(best, k, e);
+}
+
+} // namespace detail
+
+template <typename E>
+inline auto argmax(const E& e, gt::stream_view stream = gt::stream_view{})
+{
+  using T = std::decay_t<expr_value_type<E>>;
+  return detail::arg_reduce(e, detail::BinaryOpArgMax{},
+                            std::numeric_limits<T>::lowest(), stream);
+}
+
+template <typename E>
+inline auto argmin(const E& e, gt::stream_view stream = gt::stream_view{})
+{
+  using T = std::decay_t<expr_value_type<E>>;
+  return detail::arg_reduce(e, detail::BinaryOpArgMin{},
+                            std::numeric_limits<T>::max(), stream);
+}
+
+#define MAKE_ARG_AXIS_REDUCTION(NAME, OP)                                      \
+  template <typename Eout, typename Ein, size_type M>                          \
+  inline void NAME(Eout&& out, Ein&& in, gt::sarray<int, M> axes,              \
+                   gt::stream_view stream = gt::stream_view{})                 \
+  {                                                                            \
+    detail::arg_reduce_axis_to<OP>(std::forward<Eout>(out),                    \
+                                   std::forward<Ein>(in), axes, stream);       \
+  }                                                                            \
+                                                                               \
+  template <typename Eout, typename Ein>                                       \
+  inline void NAME(Eout&& out, Ein&& in, int axis,                             \
+                   gt::stream_view stream = gt::stream_view{})                 \
+  {                                                                            \
+    NAME(std::forward<Eout>(out), std::forward<Ein>(in),                       \
+         gt::sarray<int, 1>{axis}, stream);                                    \
+  }
+
+MAKE_ARG_AXIS_REDUCTION(argmax_axis_to, detail::BinaryOpArgMax)
+MAKE_ARG_AXIS_REDUCTION(argmin_axis_to, detail::BinaryOpArgMin)
+
+#undef MAKE_ARG_AXIS_REDUCTION
+
+/*! The k largest values of e with their indices, largest first, or all of
+ * them if e has fewer than k elements.
+ */
+template <typename E>
+inline auto top_k(const E& e, size_type k,
+                  gt::stream_view stream = gt::stream_view{})
+{
+  using T = std::decay_t<expr_value_type<E>>;
+  return detail::top_k_impl<T>(e, k, stream,
+                               detail::is_host_reducible<E>{});
 }
 
 } // namespace gt
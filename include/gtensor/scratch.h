@@ -0,0 +1,352 @@
+#ifndef GTENSOR_SCRATCH_H
+#define GTENSOR_SCRATCH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "defs.h"
+#include "pointer_traits.h"
+
+// smallest chunk in bytes a scratch arena gets from its allocator
+#ifndef GTENSOR_SCRATCH_CHUNK_SIZE
+#define GTENSOR_SCRATCH_CHUNK_SIZE (std::size_t(1) << 20)
+#endif
+
+// ======================================================================
+// scratch_scope
+//
+// While a scratch_scope is alive, arrays created by the same thread with
+// gt::empty or gt::eval, and the temporaries used internally by copies and
+// the BLAS wrappers, are carved out of a per-thread arena by bumping a
+// pointer, and all of it is released at once when the scope ends, e.g.
+//
+//   for (int step = 0; step < nsteps; step++) {
+//     gt::scratch_scope scratch;
+//     auto tmp = gt::eval(a + b);
+//     ...
+//   }
+//
+// The arena keeps its memory between scopes, so a loop that creates the same
+// temporaries every iteration allocates from the backend only the first
+// time. Arrays created that way within a scope must not outlive it, nor be
+// destroyed by another thread. Other containers, including ones assigned to,
+// resized or move constructed from such arrays within a scope, never use the
+// arena. Freeing the most recent
+// scratch array makes its space available again right away; other frees
+// within a scope do nothing.
+
+namespace gt
+{
+
+namespace detail
+{
+
+constexpr std::size_t SCRATCH_ALIGNMENT = 256;
+
+class scratch_arena_base
+{
+public:
+  virtual ~scratch_arena_base() {}
+
+  // undo the allocations made in scopes at this depth or deeper
+  virtual void rewind(int depth) = 0;
+
+  // give the memory back to the allocator, when no scope is alive
+  virtual void release() = 0;
+};
+
+struct scratch_thread_state
+{
+  // number of scratch scopes alive on this thread
+  int depth = 0;
+  // set by scratch_request for the next storage created with a size
+  bool request = false;
+  std::vector<scratch_arena_base*> arenas;
+};
+
+inline scratch_thread_state& get_scratch_state()
+{
+  static thread_local scratch_thread_state state;
+  return state;
+}
+
+constexpr std::size_t gcd(std::size_t a, std::size_t b)
+{
+  return b == 0 ? a : gcd(b, a % b);
+}
+
+// ----------------------------------------------------------------------
+// scratch_arena
+//
+// Per-thread arena for storage of T allocated with A. Memory comes from A in
+// chunks; when a scope ends having spilled into more than one chunk, the
+// chunks are replaced by a single one large enough for all of them.
+
+template <typename T, typename A>
+class scratch_arena : public scratch_arena_base
+{
+public:
+  using pointer = typename std::allocator_traits<A>::pointer;
+  using size_type = typename std::allocator_traits<A>::size_type;
+
+  // the calling thread's arena, created on first use
+  static scratch_arena& get()
+  {
+    static thread_local scratch_arena arena;
+    return arena;
+  }
+
+  // the calling thread's arena, or nullptr if it has never been used
+  static scratch_arena* find() { return instance(); }
+
+  pointer allocate(size_type n)
+  {
+    int depth = get_scratch_state().depth;
+    if (marks_.empty() || marks_.back().depth < depth) {
+      marks_.push_back({depth, current_, offset_});
+    }
+
+    size_type count = round_up(n);
+    while (current_ < chunks_.size() &&
+           offset_ + count > chunks_[current_].count) {
+      current_++;
+      offset_ = 0;
+    }
+    if (current_ == chunks_.size()) {
+      size_type chunk_count =
+        std::max({count, next_count_, round_up(min_chunk_count())});
+      if (!chunks_.empty()) {
+        chunk_count = std::max(chunk_count, 2 * chunks_.back().count);
+      }
+      // over-allocate so the usable part starts SCRATCH_ALIGNMENT aligned
+      size_type alloc_count = chunk_count + align_count;
+      pointer p = alloc_.allocate(alloc_count);
+      T* data = align(gt::pointer_traits<pointer>::get(p));
+      chunks_.push_back({p, alloc_count, data, chunk_count});
+      next_count_ = 0;
+    }
+
+    T* p = chunks_[current_].data + offset_;
+    offset_ += count;
+    return pointer(p);
+  }
+
+  // false if p was not allocated from this arena
+  bool deallocate(pointer p, size_type n)
+  {
+    T* data = gt::pointer_traits<pointer>::get(p);
+    for (size_type i = chunks_.size(); i-- > 0;) {
+      const chunk& c = chunks_[i];
+      if (data >= c.data && data < c.data + c.count) {
+        if (i == current_ && data + round_up(n) == c.data + offset_) {
+          offset_ = data - c.data;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void rewind(int depth) override
+  {
+    while (!marks_.empty() && marks_.back().depth >= depth) {
+      current_ = marks_.back().chunk;
+      offset_ = marks_.back().offset;
+      marks_.pop_back();
+    }
+    if (marks_.empty() && chunks_.size() > 1) {
+      size_type total = 0;
+      for (auto& c : chunks_) {
+        total += c.count;
+      }
+      release();
+      next_count_ = total;
+    }
+  }
+
+  void release() override
+  {
+    if (!marks_.empty()) {
+      return;
+    }
+    for (auto& c : chunks_) {
+      alloc_.deallocate(c.p, c.alloc_count);
+    }
+    chunks_.clear();
+    current_ = 0;
+    offset_ = 0;
+    next_count_ = 0;
+  }
+
+  scratch_arena(const scratch_arena&) = delete;
+  scratch_arena& operator=(const scratch_arena&) = delete;
+
+private:
+  struct chunk
+  {
+    pointer p;
+    size_type alloc_count;
+    T* data;
+    size_type count;
+  };
+
+  struct mark
+  {
+    int depth;
+    std::size_t chunk;
+    size_type offset;
+  };
+
+  // allocations are padded to a multiple of this many elements, which keeps
+  // them SCRATCH_ALIGNMENT aligned when sizeof(T) divides it
+  static constexpr size_type align_count =
+    SCRATCH_ALIGNMENT / gcd(SCRATCH_ALIGNMENT, sizeof(T));
+
+  scratch_arena()
+  {
+    get_scratch_state().arenas.push_back(this);
+    instance() = this;
+  }
+
+  ~scratch_arena()
+  {
+    instance() = nullptr;
+    marks_.clear();
+    release();
+  }
+
+  static scratch_arena*& instance()
+  {
+    static thread_local scratch_arena* arena = nullptr;
+    return arena;
+  }
+
+  static size_type round_up(size_type n)
+  {
+    return (n + align_count - 1) / align_count * align_count;
+  }
+
+  static T* align(T* p)
+  {
+    if (SCRATCH_ALIGNMENT % sizeof(T) != 0) {
+      return p;
+    }
+    auto addr = reinterpret_cast<std::uintptr_t>(p);
+    auto aligned = (addr + SCRATCH_ALIGNMENT - 1) / SCRATCH_ALIGNMENT *
+                   SCRATCH_ALIGNMENT;
+    return p + (aligned - addr) / sizeof(T);
+  }
+
+  static size_type min_chunk_count()
+  {
+    return (GTENSOR_SCRATCH_CHUNK_SIZE + sizeof(T) - 1) / sizeof(T);
+  }
+
+  std::vector<chunk> chunks_;
+  std::vector<mark> marks_;
+  // position of the next allocation
+  std::size_t current_ = 0;
+  size_type offset_ = 0;
+  // size of the chunk to allocate next, after consolidating
+  size_type next_count_ = 0;
+  A alloc_;
+};
+
+template <typename T, typename A>
+constexpr typename scratch_arena<T, A>::size_type
+  scratch_arena<T, A>::align_count;
+
+} // namespace detail
+
+class scratch_scope
+{
+public:
+  scratch_scope() { detail::get_scratch_state().depth++; }
+
+  ~scratch_scope()
+  {
+    auto& state = detail::get_scratch_state();
+    for (auto arena : state.arenas) {
+      arena->rewind(state.depth);
+    }
+    state.depth--;
+  }
+
+  scratch_scope(const scratch_scope&) = delete;
+  scratch_scope& operator=(const scratch_scope&) = delete;
+};
+
+// true if storage created by the calling thread comes from the scratch arena
+inline bool scratch_active() { return detail::get_scratch_state().depth > 0; }
+
+// give the calling thread's scratch memory back to the allocators; does
+// nothing while a scratch scope is alive
+inline void release_scratch()
+{
+  auto& state = detail::get_scratch_state();
+  if (state.depth == 0) {
+    for (auto arena : state.arenas) {
+      arena->release();
+    }
+  }
+}
+
+namespace detail
+{
+
+// While alive, the next storage created with a size on this thread, e.g. by
+// gt::empty, comes from the scratch arena if a scratch scope is alive.
+// Storage is never moved into or out of the arena by resizing, copying or
+// moving it.
+class scratch_request
+{
+public:
+  scratch_request() : prev_(get_scratch_state().request)
+  {
+    get_scratch_state().request = true;
+  }
+
+  ~scratch_request() { get_scratch_state().request = prev_; }
+
+  scratch_request(const scratch_request&) = delete;
+  scratch_request& operator=(const scratch_request&) = delete;
+
+private:
+  bool prev_;
+};
+
+// true if storage being created should come from the scratch arena, which
+// uses up the pending scratch_request
+inline bool take_scratch_request()
+{
+  auto& state = get_scratch_state();
+  bool request = state.request;
+  state.request = false;
+  return request && state.depth > 0;
+}
+
+template <typename T, typename A>
+inline auto scratch_allocate(typename std::allocator_traits<A>::size_type n)
+{
+  return scratch_arena<T, A>::get().allocate(n);
+}
+
+// scratch storage freed by another thread than the one that allocated it is
+// left to its arena
+template <typename T, typename A>
+inline void scratch_deallocate(typename std::allocator_traits<A>::pointer p,
+                               typename std::allocator_traits<A>::size_type n)
+{
+  auto arena = scratch_arena<T, A>::find();
+  if (arena) {
+    arena->deallocate(p, n);
+  }
+}
+
+} // namespace detail
+
+} // namespace gt
+
+#endif // GTENSOR_SCRATCH_H
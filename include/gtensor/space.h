@@ -157,6 +157,34 @@ struct has_space_type_host : has_space_type<E, gt::space::host>
 template <typename T>
 constexpr bool has_space_type_host_v = has_space_type_host<T>::value;
 
+// ======================================================================
+// expr_storage_space
+//
+// space of the containers that hold the value of an expression: its own
+// space, or the host for expressions that can be used in any space, like
+// gscalar, generators and stensor
+
+namespace detail
+{
+
+template <typename S>
+struct storage_space
+{
+  using type = S;
+};
+
+template <>
+struct storage_space<space::any>
+{
+  using type = space::host;
+};
+
+} // namespace detail
+
+template <typename E>
+using expr_storage_space =
+  typename detail::storage_space<expr_space_type<E>>::type;
+
 } // namespace gt
 
 #endif
@@ -1,7 +1,7 @@
 #ifndef GTENSOR_SPARSE_H
 #define GTENSOR_SPARSE_H
 
-#include <numeric>
+#include <algorithm>
 #include <type_traits>
 
 #include "gtensor.h"
@@ -17,7 +17,8 @@ namespace detail
 {
 
 template <typename DataArray>
-gt::gtensor<int, 1> row_ptr_batches(DataArray& d_a_batches, int nbatches)
+gt::gtensor<int, 1, typename DataArray::space_type> row_ptr_batches(
+  DataArray& d_a_batches, int nbatches)
 {
   using S = typename DataArray::space_type;
   using T = typename DataArray::value_type;
@@ -25,11 +26,15 @@ gt::gtensor<int, 1> row_ptr_batches(DataArray& d_a_batches, int nbatches)
   int nrows = d_a_batches.shape(0);
   int ncols = d_a_batches.shape(1);
   gt::gtensor<int, 2, S> d_row_nnz_counts{gt::shape(nrows, nbatches)};
-  gt::gtensor<int, 2> h_row_nnz_counts{d_row_nnz_counts.shape()};
-  gt::gtensor<int, 1> h_row_ptr{gt::shape(nrows * nbatches + 1)};
+  gt::gtensor<int, 1, S> d_row_ptr{gt::shape(nrows * nbatches + 1)};
 
   auto k_row_nnz_counts = d_row_nnz_counts.to_kernel();
   auto k_a_batches = d_a_batches.to_kernel();
+  // each row scans ncols entries; on host, hand out rows in chunks of about
+  // 16k entries on demand
+  gt::launch_policy policy;
+  policy.schedule = gt::launch_schedule::dynamic;
+  policy.grain_size = gt::div_ceil(16 * 1024, std::max(ncols, 1));
   gt::launch<2, S>(
     d_row_nnz_counts.shape(), GT_LAMBDA(int i, int b) {
       int nnz = 0;
@@ -41,15 +46,25 @@ gt::gtensor<int, 1> row_ptr_batches(DataArray& d_a_batches, int nbatches)
         }
       }
       k_row_nnz_counts(i, b) = nnz;
-    });
-  gt::copy(d_row_nnz_counts, h_row_nnz_counts);
-
-  // TODO: add scan or partial sum to reductions, keep on device?
-  h_row_ptr(0) = 0;
-  std::partial_sum(h_row_nnz_counts.data(),
-                   h_row_nnz_counts.data() + nrows * nbatches,
-                   h_row_ptr.data() + 1);
-  return h_row_ptr;
+    },
+    policy);
+
+  // row_ptr(0) = 0, followed by the inclusive scan of the counts
+  d_row_ptr.view(gt::slice(0, 1)) = 0;
+  gt::gtensor_span<int, 1, S> d_row_ptr_tail(
+    d_row_ptr.data() + 1, gt::shape(nrows * nbatches),
+    gt::calc_strides(gt::shape(nrows * nbatches)));
+  gt::inclusive_scan(d_row_nnz_counts, d_row_ptr_tail);
+  return d_row_ptr;
+}
+
+// the last element of row_ptr, which is the number of non-zeros
+template <typename RowPtr>
+int row_ptr_nnz(const RowPtr& d_row_ptr)
+{
+  int nnz;
+  gt::copy_n(d_row_ptr.data() + (d_row_ptr.size() - 1), 1, &nnz);
+  return nnz;
 }
 
 } // namespace detail
@@ -169,14 +184,11 @@ public:
     shape_ = d_a.shape();
 
     auto d_batches_view = d_a.view(gt::all, gt::all, gt::newaxis);
-    auto h_row_ptr = detail::row_ptr_batches(d_batches_view, 1);
-    nnz_ = h_row_ptr(shape_[0]);
+    row_ptr_ = detail::row_ptr_batches(d_batches_view, 1);
+    nnz_ = detail::row_ptr_nnz(row_ptr_);
 
     values_.resize({nnz_});
     col_ind_.resize({nnz_});
-    row_ptr_.resize({shape_[0] + 1});
-
-    gt::copy(h_row_ptr, row_ptr_);
 
     convert_batches(d_batches_view, row_ptr_);
   }
@@ -190,10 +202,10 @@ public:
     int ncols = d_matrix_batches.shape(1);
     int nbatches = d_matrix_batches.shape(2);
 
-    auto h_row_ptr = detail::row_ptr_batches(d_matrix_batches, nbatches);
+    auto d_row_ptr = detail::row_ptr_batches(d_matrix_batches, nbatches);
     csr_matrix csr_mat(gt::shape(nrows * nbatches, ncols * nbatches),
-                       h_row_ptr(nrows * nbatches));
-    gt::copy(h_row_ptr, csr_mat.row_ptr_);
+                       detail::row_ptr_nnz(d_row_ptr));
+    gt::copy(d_row_ptr, csr_mat.row_ptr_);
 
     csr_mat.convert_batches(d_matrix_batches, csr_mat.row_ptr_);
     return csr_mat;
@@ -0,0 +1,286 @@
+
+#ifndef GTENSOR_STENSOR_H
+#define GTENSOR_STENSOR_H
+
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "assign.h"
+#include "defs.h"
+#include "gstrided.h"
+#include "helper.h"
+#include "sarray.h"
+#include "space.h"
+
+namespace gt
+{
+
+// ======================================================================
+// stensor
+//
+// stensor<T, N0, N1, ...> : container of compile-time shape N0 x N1 x ...
+// that keeps its elements in a gt::sarray, for small coefficient tables and
+// the like, e.g.
+//
+//   gt::stensor<double, 5> stencil5 = {1. / 12., -2. / 3., 0., 2. / 3.,
+//                                      -1. / 12.};
+//   auto k_stencil5 = stencil5.to_kernel();
+//   gt::launch<1>(dydx.shape(), GT_LAMBDA(int i) {
+//     for (int s = 0; s < 5; s++) k_dydx(i) += k_stencil5(s) * k_y(i + s);
+//   });
+//
+// Creating one does not allocate, and its to_kernel() is a copy of the
+// elements, so kernels get them by value rather than through a pointer. Like
+// gscalar, it can be combined with both host and device expressions, but it
+// is itself assigned to on the host, and changes made in a kernel are not
+// seen outside of it. For the same reason, gt::assign to a stensor, or to a
+// view of one, with an asynchronous host stream waits for the work queued on
+// the stream and then assigns right away rather than queueing the assign.
+
+template <typename T, size_type... Ns>
+class stensor;
+
+namespace detail
+{
+
+constexpr size_type static_shape_size() { return 1; }
+
+template <typename... Rs>
+constexpr size_type static_shape_size(size_type n, Rs... rest)
+{
+  return n * static_shape_size(rest...);
+}
+
+} // namespace detail
+
+template <typename T, size_type... Ns>
+struct gtensor_inner_types<stensor<T, Ns...>>
+{
+  using space_type = space::any;
+  constexpr static size_type dimension = sizeof...(Ns);
+
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+};
+
+template <typename T, size_type... Ns>
+class stensor : public gstrided<stensor<T, Ns...>>
+{
+public:
+  using self_type = stensor<T, Ns...>;
+  using base_type = gstrided<self_type>;
+  using inner_types = gtensor_inner_types<self_type>;
+  using space_type = typename inner_types::space_type;
+
+  using value_type = typename inner_types::value_type;
+  using pointer = typename inner_types::pointer;
+  using const_pointer = typename inner_types::const_pointer;
+  using reference = typename inner_types::reference;
+  using const_reference = typename inner_types::const_reference;
+
+  using base_type::dimension;
+  using typename base_type::shape_type;
+  using typename base_type::strides_type;
+
+  using kernel_type = self_type;
+  using const_kernel_type = self_type;
+
+  static_assert(sizeof...(Ns) > 0, "stensor must have at least one dimension");
+
+  constexpr static size_type static_size = detail::static_shape_size(Ns...);
+
+  GT_INLINE stensor();
+  stensor(helper::nd_initializer_list_t<value_type, sizeof...(Ns)> il);
+  template <typename E>
+  stensor(const expression<E>& e);
+
+  template <typename E>
+  self_type& operator=(const expression<E>& e);
+
+  void fill(const value_type v);
+
+  const_kernel_type to_kernel() const;
+
+  GT_INLINE const_pointer data() const;
+  GT_INLINE pointer data();
+
+  template <typename... Args>
+  GT_INLINE const_reference operator()(Args&&... args) const;
+  template <typename... Args>
+  GT_INLINE reference operator()(Args&&... args);
+
+  GT_INLINE const_reference operator[](const shape_type& idx) const;
+  GT_INLINE reference operator[](const shape_type& idx);
+
+  GT_INLINE const_reference data_access(size_type i) const;
+  GT_INLINE reference data_access(size_type i);
+
+  inline std::string typestr() const&;
+
+  bool is_f_contiguous() const { return true; }
+
+private:
+  template <typename S, size_type... I>
+  GT_INLINE const_reference access(std::index_sequence<I...>,
+                                   const S& idx) const
+  {
+    return (*this)(idx[I]...);
+  }
+
+  template <typename S, size_type... I>
+  GT_INLINE reference access(std::index_sequence<I...>, const S& idx)
+  {
+    return (*this)(idx[I]...);
+  }
+
+  sarray<value_type, static_size> data_;
+};
+
+// ----------------------------------------------------------------------
+// stensor implementation
+
+template <typename T, size_type... Ns>
+constexpr size_type stensor<T, Ns...>::static_size;
+
+template <typename T, size_type... Ns>
+GT_INLINE stensor<T, Ns...>::stensor()
+  : base_type(shape_type(int(Ns)...), calc_strides(shape_type(int(Ns)...)))
+{}
+
+template <typename T, size_type... Ns>
+inline stensor<T, Ns...>::stensor(
+  helper::nd_initializer_list_t<value_type, sizeof...(Ns)> il)
+  : stensor()
+{
+  // same ordering as gtensor: the innermost list runs along dimension 0
+  assert(helper::nd_initializer_list_shape<sizeof...(Ns)>(il) ==
+         this->shape());
+  helper::nd_initializer_list_copy<sizeof...(Ns)>(il, *this);
+}
+
+template <typename T, size_type... Ns>
+template <typename E>
+inline stensor<T, Ns...>::stensor(const expression<E>& e) : stensor()
+{
+  *this = e;
+}
+
+template <typename T, size_type... Ns>
+template <typename E>
+inline auto stensor<T, Ns...>::operator=(const expression<E>& e) -> self_type&
+{
+  static_assert(expr_dimension<E>() == dimension(),
+                "cannot assign expressions of different dimension");
+  static_assert(std::is_same<expr_space_type<E>, space::host>::value ||
+                  std::is_same<expr_space_type<E>, space::any>::value,
+                "stensor can only be assigned host expressions");
+  detail::valid_assign_broadcast_or_throw(this->shape(), e.derived().shape());
+  detail::assigner<dimension(), space::host>::run(*this, e.derived(),
+                                                  gt::stream_view{});
+  return *this;
+}
+
+template <typename T, size_type... Ns>
+inline void stensor<T, Ns...>::fill(const value_type v)
+{
+  for (size_type i = 0; i < static_size; i++) {
+    data_[i] = v;
+  }
+}
+
+template <typename T, size_type... Ns>
+inline auto stensor<T, Ns...>::to_kernel() const -> const_kernel_type
+{
+  return *this;
+}
+
+template <typename T, size_type... Ns>
+GT_INLINE auto stensor<T, Ns...>::data() const -> const_pointer
+{
+  return data_.data();
+}
+
+template <typename T, size_type... Ns>
+GT_INLINE auto stensor<T, Ns...>::data() -> pointer
+{
+  return data_.data();
+}
+
+template <typename T, size_type... Ns>
+template <typename... Args>
+GT_INLINE auto stensor<T, Ns...>::operator()(Args&&... args) const
+  -> const_reference
+{
+  return data_access(base_type::index(std::forward<Args>(args)...));
+}
+
+template <typename T, size_type... Ns>
+template <typename... Args>
+GT_INLINE auto stensor<T, Ns...>::operator()(Args&&... args) -> reference
+{
+  return data_access(base_type::index(std::forward<Args>(args)...));
+}
+
+template <typename T, size_type... Ns>
+GT_INLINE auto stensor<T, Ns...>::operator[](const shape_type& idx) const
+  -> const_reference
+{
+  return access(std::make_index_sequence<sizeof...(Ns)>(), idx);
+}
+
+template <typename T, size_type... Ns>
+GT_INLINE auto stensor<T, Ns...>::operator[](const shape_type& idx)
+  -> reference
+{
+  return access(std::make_index_sequence<sizeof...(Ns)>(), idx);
+}
+
+template <typename T, size_type... Ns>
+GT_INLINE auto stensor<T, Ns...>::data_access(size_type i) const
+  -> const_reference
+{
+  return data_[i];
+}
+
+template <typename T, size_type... Ns>
+GT_INLINE auto stensor<T, Ns...>::data_access(size_type i) -> reference
+{
+  return data_[i];
+}
+
+template <typename T, size_type... Ns>
+inline std::string stensor<T, Ns...>::typestr() const&
+{
+  std::stringstream s;
+  s << "st" << sizeof...(Ns) << "<" << get_type_name<T>() << ">"
+    << this->shape() << this->strides();
+  return s.str();
+}
+
+// ======================================================================
+// is_stensor
+
+template <typename E>
+struct is_stensor : std::false_type
+{};
+
+template <typename T, size_type... Ns>
+struct is_stensor<stensor<T, Ns...>> : std::true_type
+{};
+
+namespace detail
+{
+
+template <typename T, size_type... Ns>
+struct has_strided_data_access<stensor<T, Ns...>> : std::true_type
+{};
+
+} // namespace detail
+
+} // namespace gt
+
+#endif
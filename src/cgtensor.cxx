@@ -1,8 +1,97 @@
 #include <stdint.h>
 
+#include <mutex>
+#include <unordered_map>
+
 #include <gtensor/capi.h>
 #include <gtensor/gtensor.h>
 
+namespace
+{
+
+// the C deallocation functions are not given the size, so it is kept here
+class clib_allocations
+{
+public:
+  template <typename S>
+  void* allocate(size_t nbytes)
+  {
+    void* p = gt::backend::gallocator<S>::template allocate<uint8_t>(nbytes);
+    if (p != nullptr) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sizes_[p] = nbytes;
+      }
+      gt::detail::record_allocation(kind<S>(), p, nbytes);
+    }
+    return p;
+  }
+
+  template <typename S>
+  void deallocate(void* p)
+  {
+    if (p != nullptr) {
+      size_t nbytes = 0;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sizes_.find(p);
+        if (it != sizes_.end()) {
+          nbytes = it->second;
+          sizes_.erase(it);
+        }
+      }
+      gt::detail::record_deallocation(kind<S>(), p, nbytes);
+    }
+    gt::backend::gallocator<S>::deallocate((uint8_t*)p);
+  }
+
+private:
+  template <typename S>
+  static constexpr gt::allocation_space kind()
+  {
+    return gt::detail::space_allocation_kind<S>::value;
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<void*, size_t> sizes_;
+};
+
+clib_allocations& get_clib_allocations()
+{
+  static clib_allocations allocations;
+  return allocations;
+}
+
+static_assert(GT_ALLOCATION_SPACE_HOST == int(gt::allocation_space::host) &&
+                GT_ALLOCATION_SPACE_HOST_PINNED ==
+                  int(gt::allocation_space::host_pinned) &&
+                GT_ALLOCATION_SPACE_DEVICE ==
+                  int(gt::allocation_space::device) &&
+                GT_ALLOCATION_SPACE_MANAGED ==
+                  int(gt::allocation_space::managed),
+              "allocation space mismatch");
+
+bool is_allocation_space(int space)
+{
+  return space >= 0 && space < gt::ALLOCATION_SPACES;
+}
+
+void copy_allocation_stats(const gt::allocation_stats& src,
+                           gt_allocation_stats* dst)
+{
+  static_assert(GT_ALLOCATION_HISTOGRAM_BINS == gt::ALLOCATION_HISTOGRAM_BINS,
+                "histogram size mismatch");
+  dst->live_bytes = src.live_bytes;
+  dst->peak_bytes = src.peak_bytes;
+  dst->num_allocations = src.num_allocations;
+  dst->num_deallocations = src.num_deallocations;
+  for (int i = 0; i < GT_ALLOCATION_HISTOGRAM_BINS; i++) {
+    dst->histogram[i] = src.histogram[i];
+  }
+}
+
+} // namespace
+
 void gt_synchronize() { gt::synchronize(); }
 
 int gt_backend_device_get_count()
@@ -24,35 +113,32 @@ uint32_t gt_backend_device_get_vendor_id(int device_id)
 
 void* gt_backend_host_allocate(size_t nbytes)
 {
-  return (void*)
-    gt::backend::gallocator<gt::space::clib_host>::allocate<uint8_t>(nbytes);
+  return get_clib_allocations().allocate<gt::space::clib_host>(nbytes);
 }
 
 void* gt_backend_device_allocate(size_t nbytes)
 {
-  return (void*)
-    gt::backend::gallocator<gt::space::clib_device>::allocate<uint8_t>(nbytes);
+  return get_clib_allocations().allocate<gt::space::clib_device>(nbytes);
 }
 
 void* gt_backend_managed_allocate(size_t nbytes)
 {
-  return (void*)
-    gt::backend::gallocator<gt::space::clib_managed>::allocate<uint8_t>(nbytes);
+  return get_clib_allocations().allocate<gt::space::clib_managed>(nbytes);
 }
 
 void gt_backend_host_deallocate(void* p)
 {
-  gt::backend::gallocator<gt::space::clib_host>::deallocate((uint8_t*)p);
+  get_clib_allocations().deallocate<gt::space::clib_host>(p);
 }
 
 void gt_backend_device_deallocate(void* p)
 {
-  gt::backend::gallocator<gt::space::clib_device>::deallocate((uint8_t*)p);
+  get_clib_allocations().deallocate<gt::space::clib_device>(p);
 }
 
 void gt_backend_managed_deallocate(void* p)
 {
-  gt::backend::gallocator<gt::space::clib_managed>::deallocate((uint8_t*)p);
+  get_clib_allocations().deallocate<gt::space::clib_managed>(p);
 }
 
 #ifdef GTENSOR_HAVE_DEVICE
@@ -113,3 +199,33 @@ void gt_backend_prefetch_host(void* p, size_t nbytes)
 {
   gt::backend::clib::prefetch_device<uint8_t>(static_cast<uint8_t*>(p), nbytes);
 }
+
+void gt_get_allocation_stats(int space, gt_allocation_stats* stats)
+{
+  if (!is_allocation_space(space)) {
+    *stats = gt_allocation_stats{};
+    return;
+  }
+  copy_allocation_stats(
+    gt::get_allocation_stats(static_cast<gt::allocation_space>(space)), stats);
+}
+
+void gt_get_tagged_allocation_stats(int space, const char* tag,
+                                    gt_allocation_stats* stats)
+{
+  if (!is_allocation_space(space)) {
+    *stats = gt_allocation_stats{};
+    return;
+  }
+  copy_allocation_stats(
+    gt::get_allocation_stats(static_cast<gt::allocation_space>(space), tag),
+    stats);
+}
+
+void gt_reset_allocation_peak(int space)
+{
+  if (!is_allocation_space(space)) {
+    return;
+  }
+  gt::reset_allocation_peak(static_cast<gt::allocation_space>(space));
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "gtensor/gtensor.h"
+
+#include "test_debug.h"
+
+// what gt::space::host allocations are counted as, host_pinned in device builds
+constexpr auto host_allocation_space =
+  gt::detail::space_allocation_kind<gt::space::host>::value;
+
+TEST(allocation_stats, host)
+{
+  auto space = host_allocation_space;
+  auto before = gt::get_allocation_stats(space);
+
+  {
+    gt::backend::host_storage<char> h(1000);
+    auto stats = gt::get_allocation_stats(space);
+    EXPECT_EQ(stats.live_bytes, before.live_bytes + 1000);
+    EXPECT_GE(stats.peak_bytes, stats.live_bytes);
+    EXPECT_EQ(stats.num_allocations, before.num_allocations + 1);
+    EXPECT_EQ(stats.num_deallocations, before.num_deallocations);
+    // 512 <= 1000 < 1024
+    EXPECT_EQ(stats.histogram[9], before.histogram[9] + 1);
+  }
+
+  auto after = gt::get_allocation_stats(space);
+  EXPECT_EQ(after.live_bytes, before.live_bytes);
+  EXPECT_GE(after.peak_bytes, before.live_bytes + 1000);
+  EXPECT_EQ(after.num_deallocations, before.num_deallocations + 1);
+
+  gt::reset_allocation_peak(space);
+  after = gt::get_allocation_stats(space);
+  EXPECT_EQ(after.peak_bytes, after.live_bytes);
+}
+
+TEST(allocation_stats, tag)
+{
+  auto space = host_allocation_space;
+  {
+    gt::allocation_tag tag("outer");
+    gt::backend::host_storage<double> a(100);
+    {
+      gt::allocation_tag inner("inner");
+      gt::backend::host_storage<double> b(10);
+      auto stats = gt::get_allocation_stats(space, "inner");
+      EXPECT_EQ(stats.live_bytes, 80);
+      EXPECT_EQ(stats.num_allocations, 1);
+    }
+    gt::backend::host_storage<double> c(100);
+
+    auto stats = gt::get_allocation_stats(space, "outer");
+    EXPECT_EQ(stats.live_bytes, 1600);
+    EXPECT_EQ(stats.peak_bytes, 1600);
+    EXPECT_EQ(stats.num_allocations, 2);
+  }
+  gt::backend::host_storage<double> untagged(100);
+
+  auto stats = gt::get_allocation_stats(space, "outer");
+  EXPECT_EQ(stats.live_bytes, 0);
+  EXPECT_EQ(stats.num_deallocations, 2);
+  stats = gt::get_allocation_stats(space, "inner");
+  EXPECT_EQ(stats.live_bytes, 0);
+  EXPECT_EQ(stats.num_deallocations, 1);
+  EXPECT_EQ(gt::get_allocation_stats(space, "unused").num_allocations, 0);
+
+  auto tags = gt::get_allocation_tags();
+  EXPECT_NE(std::find(tags.begin(), tags.end(), "outer"), tags.end());
+  EXPECT_NE(std::find(tags.begin(), tags.end(), "inner"), tags.end());
+}
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtensor/gtensor.h"
+
+#include "test_debug.h"
+
+TEST(allocator, caching_allocator_size_class)
+{
+  using gt::allocator::detail::get_size_class;
+
+  EXPECT_EQ(get_size_class(1).index, 0);
+  EXPECT_EQ(get_size_class(1).nbytes, 256);
+  EXPECT_EQ(get_size_class(256).nbytes, 256);
+  EXPECT_EQ(get_size_class(257).index, 1);
+  EXPECT_EQ(get_size_class(257).nbytes, 320);
+  EXPECT_EQ(get_size_class(512).index, 4);
+  EXPECT_EQ(get_size_class(512).nbytes, 512);
+  EXPECT_EQ(get_size_class(513).index, 5);
+  EXPECT_EQ(get_size_class(513).nbytes, 640);
+  EXPECT_EQ(get_size_class(800).nbytes, 896);
+  EXPECT_EQ(get_size_class(std::size_t(1) << 30).nbytes,
+            std::size_t(1) << 30);
+}
+
+TEST(allocator, caching_allocator_reuse)
+{
+  using A =
+    gt::allocator::caching_allocator<double, gt::host_allocator<double>>;
+  A::clear_cache();
+  A a;
+
+  auto p1 = a.allocate(100);
+  a.deallocate(p1, 100);
+  EXPECT_EQ(A::cached_bytes(), 896);
+
+  // same size class, so the cached block is reused
+  auto p2 = a.allocate(97);
+  EXPECT_EQ(p2, p1);
+  EXPECT_EQ(A::cached_bytes(), 0);
+  a.deallocate(p2, 97);
+
+  // large blocks go to the shared free lists
+  auto p3 = a.allocate(1 << 20);
+  a.deallocate(p3, 1 << 20);
+  EXPECT_EQ(A::cached_bytes(), 896 + (8 << 20));
+  auto p4 = a.allocate(1 << 20);
+  EXPECT_EQ(p4, p3);
+  a.deallocate(p4, 1 << 20);
+
+  A::clear_cache();
+  EXPECT_EQ(A::cached_bytes(), 0);
+}
+
+TEST(allocator, caching_allocator_limit)
+{
+  using A =
+    gt::allocator::caching_allocator<double, gt::host_allocator<double>>;
+  A::clear_cache();
+  auto limit = A::cache_limit();
+  A a;
+
+  auto p1 = a.allocate(1024);
+  auto p2 = a.allocate(1024);
+  a.deallocate(p1, 1024);
+  EXPECT_EQ(A::cached_bytes(), 8192);
+
+  A::set_cache_limit(12 * 1024);
+  a.deallocate(p2, 1024);
+  EXPECT_EQ(A::cached_bytes(), 8192);
+
+  // shrinking the limit trims what is cached
+  A::set_cache_limit(4096);
+  EXPECT_EQ(A::cached_bytes(), 0);
+
+  A::set_cache_limit(limit);
+}
+
+TEST(allocator, caching_allocator_threads)
+{
+  using A =
+    gt::allocator::caching_allocator<double, gt::host_allocator<double>>;
+  constexpr int nthreads = 4;
+  constexpr int niter = 1000;
+  std::vector<std::thread> threads;
+  std::vector<int> errors(nthreads, 0);
+
+  for (int t = 0; t < nthreads; t++) {
+    threads.emplace_back([t, &errors]() {
+      A a;
+      std::vector<std::pair<double*, int>> live;
+      for (int i = 0; i < niter; i++) {
+        int n = 1 + (i * 37 + t * 101) % 3000;
+        double* p = gt::raw_pointer_cast(a.allocate(n));
+        for (int j = 0; j < n; j++) {
+          p[j] = t + i;
+        }
+        live.emplace_back(p, n);
+        if (live.size() > 8) {
+          auto blk = live.front();
+          live.erase(live.begin());
+          for (int j = 0; j < blk.second; j++) {
+            if (blk.first[j] != t + i - 8) {
+              errors[t]++;
+            }
+          }
+          a.deallocate(blk.first, blk.second);
+        }
+      }
+      for (auto& blk : live) {
+        a.deallocate(blk.first, blk.second);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < nthreads; t++) {
+    EXPECT_EQ(errors[t], 0);
+  }
+  A::clear_cache();
+  EXPECT_EQ(A::cached_bytes(), 0);
+}
+
+#if !defined(GTENSOR_HAVE_DEVICE) &&                                          \
+  (defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                   \
+   defined(GTENSOR_HOST_PARALLEL_OPENMP))
+
+TEST(allocator, caching_allocator_stream_ordered)
+{
+  using A =
+    gt::allocator::caching_allocator<double, gt::host_allocator<double>>;
+  A::clear_cache();
+  A a;
+
+  gt::stream busy;
+  gt::stream idle;
+  std::atomic<bool> release{false};
+  std::atomic<bool> done{false};
+  busy.get_view().submit([&] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  auto p1 = a.allocate(100);
+  auto p2 = a.allocate(100);
+  {
+    gt::deallocation_stream ds(busy.get_view());
+    a.deallocate(p1, 100);
+  }
+  {
+    gt::deallocation_stream ds(idle.get_view());
+    a.deallocate(p2, 100);
+  }
+
+  // the block still in use on the busy stream is skipped
+  auto p3 = a.allocate(100);
+  EXPECT_EQ(p3, p2);
+  EXPECT_FALSE(done);
+
+  // with no other block left, allocating gets new memory instead of waiting
+  // for the busy stream's work
+  auto p4 = a.allocate(100);
+  EXPECT_NE(p4, p1);
+  EXPECT_FALSE(done);
+
+  // once that work has completed, its block is reused
+  release = true;
+  busy.synchronize();
+  auto p5 = a.allocate(100);
+  EXPECT_EQ(p5, p1);
+
+  a.deallocate(p3, 100);
+  a.deallocate(p4, 100);
+  a.deallocate(p5, 100);
+  A::clear_cache();
+}
+
+TEST(allocator, caching_allocator_trim_pending)
+{
+  using A =
+    gt::allocator::caching_allocator<double, gt::host_allocator<double>>;
+  constexpr int n = 1 << 20;
+  A::clear_cache();
+  A a;
+
+  gt::stream busy;
+  std::atomic<bool> release{false};
+  std::atomic<bool> done{false};
+  busy.get_view().submit([&] {
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!release && std::chrono::steady_clock::now() < timeout) {
+      std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  // a shared block still in use on the busy stream
+  auto p1 = a.allocate(n);
+  {
+    gt::deallocation_stream ds(busy.get_view());
+    a.deallocate(p1, n);
+  }
+  auto nbytes = A::cached_bytes();
+  EXPECT_GT(nbytes, 0);
+
+  // trimming skips the block instead of waiting for the busy stream
+  A::trim(0);
+  EXPECT_EQ(A::cached_bytes(), nbytes);
+  EXPECT_FALSE(done);
+
+  // and so does the free that goes over the cache limit
+  auto limit = A::cache_limit();
+  A::set_cache_limit(nbytes);
+  auto p2 = a.allocate(n);
+  EXPECT_NE(p2, p1);
+  a.deallocate(p2, n);
+  EXPECT_EQ(A::cached_bytes(), nbytes);
+  EXPECT_FALSE(done);
+
+  release = true;
+  busy.synchronize();
+  A::trim(0);
+  EXPECT_EQ(A::cached_bytes(), 0);
+  A::set_cache_limit(limit);
+}
+
+#endif
+
+TEST(allocator, host_alignment)
+{
+  for (int n : {1, 3, 17, 1000}) {
+    gt::backend::host_storage<char> h(n);
+    EXPECT_TRUE(gt::is_aligned(h.data()));
+    EXPECT_TRUE(gt::is_aligned(h.data(), 64));
+  }
+
+  gt::gtensor<float, 2, gt::space::host> a(gt::shape(3, 5));
+  EXPECT_TRUE(gt::is_aligned(a.data()));
+}
+
+#ifndef GTENSOR_USE_MEMORY_POOL
+
+// Note: pool blocks are only aligned to huge pages if they start a chunk
+TEST(allocator, host_huge_page_alignment)
+{
+  auto threshold = gt::backend::host::huge_page_threshold();
+  gt::backend::host::set_huge_page_threshold(1 << 20);
+
+  gt::backend::host_storage<double> small(1000);
+  gt::backend::host_storage<double> large(1 << 19);
+  EXPECT_TRUE(gt::is_aligned(small.data()));
+  EXPECT_TRUE(
+    gt::is_aligned(large.data(), gt::backend::host::HUGE_PAGE_SIZE));
+  large[(1 << 19) - 1] = 1.;
+  EXPECT_EQ(large[(1 << 19) - 1], 1.);
+
+  gt::backend::host::set_huge_page_threshold(threshold);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
@@ -81,6 +82,293 @@ TEST(assign, broadcast_6d)
   }
 }
 
+TEST(assign, host_large_3d)
+{
+  // large enough to be split across host workers
+  gt::gtensor<double, 3> a(gt::shape(64, 48, 40));
+  gt::gtensor<double, 3> b(a.shape());
+  gt::gtensor<double, 3> c(a.shape());
+
+  double* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = i;
+  }
+  c.fill(2.0);
+
+  a = b * c + 1.0;
+
+  double* adata = a.data();
+  for (int i = 0; i < a.size(); i++) {
+    ASSERT_EQ(adata[i], 2.0 * i + 1.0);
+  }
+}
+
+TEST(assign, host_large_trailing_broadcast)
+{
+  // outer dimensions are trivial, so work is split along the first axis
+  gt::gtensor<int, 4> a(gt::shape(200000, 1, 1, 1), 0);
+  gt::gtensor<int, 4> b(gt::shape(1, 1, 1, 1), 3);
+
+  gt::assign(a, b);
+
+  EXPECT_EQ(a, gt::full<int>(a.shape(), 3));
+}
+
+TEST(assign, host_large_view_2d)
+{
+  gt::gtensor<int, 2> a(gt::shape(300, 400), -1);
+  gt::gtensor<int, 2> b(gt::shape(150, 400));
+
+  int* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = i;
+  }
+
+  a.view(gt::slice(0, gt::none, 2), gt::all) = b;
+
+  for (int j = 0; j < a.shape(1); j++) {
+    for (int i = 0; i < a.shape(0); i++) {
+      if (i % 2 == 0) {
+        ASSERT_EQ(a(i, j), b(i / 2, j));
+      } else {
+        ASSERT_EQ(a(i, j), -1);
+      }
+    }
+  }
+}
+
+TEST(assign, host_large_view_1d)
+{
+  gt::gtensor<int, 1> a(gt::shape(400000), -1);
+  gt::gtensor<int, 1> b(gt::shape(200000));
+
+  int* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = i;
+  }
+
+  a.view(gt::slice(0, gt::none, 2)) = b + 1;
+
+  for (int i = 0; i < a.shape(0); i++) {
+    if (i % 2 == 0) {
+      ASSERT_EQ(a(i), i / 2 + 1);
+    } else {
+      ASSERT_EQ(a(i), -1);
+    }
+  }
+
+  b = a.view(gt::slice(1, gt::none, 2));
+
+  EXPECT_EQ(b, gt::full<int>(b.shape(), -1));
+}
+
+TEST(assign, host_strided_evaluator_enabled)
+{
+  gt::gtensor<double, 2> a(gt::shape(4, 3));
+  gt::gtensor<double, 2> b(gt::shape(4, 3));
+  auto a_span = gt::adapt(a.data(), a.shape());
+  auto a_view = a.view(gt::slice(1, 3), gt::all);
+  auto fn_view = (a + b).view(gt::slice(1, 3), gt::all);
+
+  EXPECT_TRUE(gt::detail::host_strided_evaluator<decltype(a)>::enabled);
+  EXPECT_TRUE(gt::detail::host_strided_evaluator<decltype(a_span)>::enabled);
+  EXPECT_TRUE(gt::detail::host_strided_evaluator<decltype(a_view)>::enabled);
+  EXPECT_TRUE(
+    (gt::detail::host_strided_evaluator<const decltype(2. * a + b)>::enabled));
+  EXPECT_FALSE(gt::detail::host_strided_evaluator<decltype(fn_view)>::enabled);
+}
+
+TEST(assign, host_6d_contiguous)
+{
+  auto shape = gt::shape(3, 4, 5, 2, 3, 7);
+  gt::gtensor<double, 6> a(shape);
+  gt::gtensor<double, 6> b(shape);
+  gt::gtensor<double, 6> c(shape);
+
+  double* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = i;
+  }
+  c.fill(0.5);
+
+  a = 2. * b - c;
+
+  double* adata = a.data();
+  for (int i = 0; i < a.size(); i++) {
+    ASSERT_EQ(adata[i], 2. * i - 0.5);
+  }
+}
+
+TEST(assign, host_broadcast_axis)
+{
+  gt::gtensor<double, 3> a(gt::shape(5, 4, 3));
+  gt::gtensor<double, 3> b(a.shape(), 1.);
+  gt::gtensor<double, 1> c{10., 20., 30., 40., 50.};
+  gt::gtensor<double, 1> d{100., 200., 300.};
+
+  a = b + c.view(gt::all, gt::newaxis, gt::newaxis) +
+      d.view(gt::newaxis, gt::newaxis, gt::all);
+
+  for (int k = 0; k < a.shape(2); k++) {
+    for (int j = 0; j < a.shape(1); j++) {
+      for (int i = 0; i < a.shape(0); i++) {
+        ASSERT_EQ(a(i, j, k), 1. + c(i) + d(k));
+      }
+    }
+  }
+}
+
+TEST(assign, host_strided_mixed_views)
+{
+  gt::gtensor<int, 3> a(gt::shape(6, 5, 4), 0);
+  gt::gtensor<int, 3> b(gt::shape(6, 5, 4));
+
+  int* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = i;
+  }
+
+  // reversed inner dimension, inner block of outer dimensions
+  auto bv = b.view(gt::slice(gt::none, gt::none, -1), gt::all, gt::all);
+  a.view(gt::all, gt::slice(1, 4), gt::all) =
+    bv.view(gt::all, gt::slice(0, 3), gt::all);
+
+  for (int k = 0; k < a.shape(2); k++) {
+    for (int j = 0; j < a.shape(1); j++) {
+      for (int i = 0; i < a.shape(0); i++) {
+        if (j >= 1 && j < 4) {
+          ASSERT_EQ(a(i, j, k), b(5 - i, j - 1, k));
+        } else {
+          ASSERT_EQ(a(i, j, k), 0);
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void test_host_packed_ops()
+{
+  // odd size, so the packed loop leaves a scalar tail
+  const int n = 37;
+  gt::gtensor<T, 1> a(gt::shape(n));
+  gt::gtensor<T, 1> b(gt::shape(n));
+  gt::gtensor<T, 1> c(gt::shape(n));
+
+  for (int i = 0; i < n; i++) {
+    b(i) = T(i + 1);
+    c(i) = T(0.5 * i);
+  }
+
+  a = (b + c) * b - c / b + T(2);
+  for (int i = 0; i < n; i++) {
+    T expected = (b(i) + c(i)) * b(i) - c(i) / b(i) + T(2);
+    ASSERT_LE(gt::abs(a(i) - expected), 1e-5 * gt::abs(expected));
+  }
+
+  a = -gt::abs(c - b);
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(a(i), -T(gt::abs(c(i) - b(i))));
+  }
+}
+
+TEST(assign, host_packed_double) { test_host_packed_ops<double>(); }
+
+TEST(assign, host_packed_float) { test_host_packed_ops<float>(); }
+
+TEST(assign, host_packed_complex_double)
+{
+  test_host_packed_ops<gt::complex<double>>();
+}
+
+TEST(assign, host_packed_complex_float)
+{
+  test_host_packed_ops<gt::complex<float>>();
+}
+
+TEST(assign, host_packed_transcendental)
+{
+  const int n = 21;
+  gt::gtensor<double, 2> a(gt::shape(n, 3));
+  gt::gtensor<double, 2> b(a.shape());
+
+  double* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = 0.1 * i;
+  }
+
+  a = gt::sin(b) * gt::cos(b) + gt::exp(-b) - gt::tan(0.5 * b);
+
+  for (int j = 0; j < a.shape(1); j++) {
+    for (int i = 0; i < a.shape(0); i++) {
+      double x = b(i, j);
+      ASSERT_NEAR(a(i, j),
+                  std::sin(x) * std::cos(x) + std::exp(-x) - std::tan(0.5 * x),
+                  1e-14);
+    }
+  }
+}
+
+TEST(assign, host_transpose)
+{
+  gt::gtensor<int, 2> a(gt::shape(3, 4));
+  gt::gtensor<int, 2> b{{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+
+  a = gt::transpose(b, gt::shape(1, 0));
+
+  for (int j = 0; j < a.shape(1); j++) {
+    for (int i = 0; i < a.shape(0); i++) {
+      ASSERT_EQ(a(i, j), b(j, i));
+    }
+  }
+}
+
+TEST(assign, host_transpose_tiled)
+{
+  // not a multiple of the tile size in either dimension
+  gt::gtensor<double, 2> a(gt::shape(70, 100));
+  gt::gtensor<double, 2> b(gt::shape(100, 70));
+
+  double* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = i;
+  }
+
+  a = 2. * gt::transpose(b, gt::shape(1, 0));
+
+  for (int j = 0; j < a.shape(1); j++) {
+    for (int i = 0; i < a.shape(0); i++) {
+      ASSERT_EQ(a(i, j), 2. * b(j, i));
+    }
+  }
+}
+
+TEST(assign, host_swapaxes_tiled)
+{
+  gt::gtensor<int, 3> a(gt::shape(40, 3, 50));
+  gt::gtensor<int, 3> b(gt::shape(50, 3, 40));
+
+  int* bdata = b.data();
+  for (int i = 0; i < b.size(); i++) {
+    bdata[i] = i;
+  }
+
+  a = gt::swapaxes(b, 0, 2);
+
+  for (int k = 0; k < a.shape(2); k++) {
+    for (int j = 0; j < a.shape(1); j++) {
+      for (int i = 0; i < a.shape(0); i++) {
+        ASSERT_EQ(a(i, j, k), b(k, j, i));
+      }
+    }
+  }
+
+  // transposed lhs
+  gt::gtensor<int, 3> c(b.shape());
+  gt::swapaxes(c, 0, 2) = a;
+  EXPECT_EQ(c, b);
+}
+
 #ifdef GTENSOR_HAVE_DEVICE
 
 TEST(assign, device_gtensor_6d)
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtensor/async_writer.h>
+#include <gtensor/gtensor.h>
+
+#include "test_debug.h"
+
+using namespace gt::placeholders;
+
+namespace
+{
+
+// temporary directory that is removed, with the snapshots in it, when going
+// out of scope
+struct temp_dir
+{
+  temp_dir()
+  {
+    char name[] = "/tmp/gtensor_test_async_writer_XXXXXX";
+    EXPECT_NE(mkdtemp(name), nullptr);
+    path = name;
+  }
+
+  ~temp_dir()
+  {
+    for (auto& f : files) {
+      std::remove(f.c_str());
+    }
+    rmdir(path.c_str());
+  }
+
+  std::string file(const std::string& name)
+  {
+    files.push_back(path + "/" + name);
+    return files.back();
+  }
+
+  std::string path;
+  std::vector<std::string> files;
+};
+
+} // namespace
+
+TEST(async_writer, write)
+{
+  temp_dir dir;
+  gt::io::async_writer writer;
+  EXPECT_EQ(writer.nbuffers(), 2);
+
+  // more snapshots than buffers, so that write() has to wait for some
+  gt::gtensor<double, 2> a(gt::shape(64, 32));
+  for (int step = 0; step < 8; step++) {
+    a = gt::full_like(a, double(step));
+    writer.write(dir.file("a_" + std::to_string(step) + ".npy"), a);
+    // the snapshot has been staged, a can change right away
+    a = gt::full_like(a, -1.);
+  }
+  writer.wait();
+
+  for (int step = 0; step < 8; step++) {
+    auto b = gt::load_npy<double, 2>(dir.path + "/a_" + std::to_string(step) +
+                                     ".npy");
+    EXPECT_EQ(b, gt::full_like(b, double(step)));
+  }
+}
+
+TEST(async_writer, write_view)
+{
+  temp_dir dir;
+  gt::io::async_writer writer(3);
+  gt::gtensor<int, 2> a{{1, 2, 3}, {4, 5, 6}};
+
+  writer.write(dir.file("v.npy"), a.view(_s(1, 3), _all));
+  writer.write(dir.file("e.npy"), a + 10);
+  writer.wait();
+
+  EXPECT_EQ((gt::load_npy<int, 2>(dir.path + "/v.npy")),
+            (gt::gtensor<int, 2>{{2, 3}, {5, 6}}));
+  EXPECT_EQ((gt::load_npy<int, 2>(dir.path + "/e.npy")),
+            (gt::gtensor<int, 2>{{11, 12, 13}, {14, 15, 16}}));
+}
+
+TEST(async_writer, error)
+{
+  temp_dir dir;
+  gt::io::async_writer writer;
+  gt::gtensor<int, 1> a{1, 2, 3};
+
+  writer.write(dir.path + "/missing/a.npy", a);
+  EXPECT_THROW(writer.wait(), std::runtime_error);
+
+  // the writer keeps working after an error
+  writer.write(dir.file("a.npy"), a);
+  writer.wait();
+  EXPECT_EQ((gt::load_npy<int, 1>(dir.path + "/a.npy")), a);
+}
+
+template <typename S>
+void test_write_stream()
+{
+  temp_dir dir;
+  gt::io::async_writer writer;
+  gt::stream stream;
+
+  gt::gtensor<float, 1, S> one(gt::shape(1000), 1.f);
+  gt::gtensor<float, 1, S> a(one.shape());
+  gt::assign(a, one, stream.get_view());
+  // staged after the assignment above, in stream order
+  writer.write(dir.file("a.npy"), a, stream.get_view());
+  writer.wait();
+
+  auto b = gt::load_npy<float, 1>(dir.path + "/a.npy");
+  EXPECT_EQ(b, gt::full_like(b, 1.f));
+}
+
+TEST(async_writer, host_write_stream)
+{
+  test_write_stream<gt::space::host>();
+}
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+TEST(async_writer, device_write_stream)
+{
+  test_write_stream<gt::space::device>();
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <cstring>
+
 #include <gtensor/gtensor.h>
 
 #include <gtensor/capi.h>
@@ -177,3 +179,22 @@ TEST(clib, mix_managed_host)
 }
 
 #endif // GTENSOR_HAVE_DEVICE
+
+TEST(clib, allocation_stats_invalid_space)
+{
+  gt_allocation_stats stats;
+  for (int space : {-1, GT_ALLOCATION_SPACE_MANAGED + 1}) {
+    std::memset(&stats, 0xff, sizeof(stats));
+    gt_get_allocation_stats(space, &stats);
+    EXPECT_EQ(stats.live_bytes, 0);
+    EXPECT_EQ(stats.num_allocations, 0);
+    EXPECT_EQ(stats.histogram[GT_ALLOCATION_HISTOGRAM_BINS - 1], 0);
+
+    std::memset(&stats, 0xff, sizeof(stats));
+    gt_get_tagged_allocation_stats(space, "tag", &stats);
+    EXPECT_EQ(stats.peak_bytes, 0);
+    EXPECT_EQ(stats.num_deallocations, 0);
+
+    gt_reset_allocation_peak(space);
+  }
+}
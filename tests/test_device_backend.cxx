@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <stdexcept>
 #include <stdint.h>
+#include <vector>
 
 #include <gtensor/gtensor.h>
 
@@ -173,3 +175,31 @@ TEST(device_backend, sycl_new_stream_queue)
 }
 
 #endif // GTENSOR_DEVICE_SYCL
+
+TEST(device_backend, host_parallel_for)
+{
+  const gt::size_type n = 100003;
+  std::vector<int> hits(n, 0);
+
+  gt::backend::host::parallel_for(
+    n, 1000, [&](gt::size_type begin, gt::size_type end) {
+      for (gt::size_type i = begin; i < end; i++) {
+        hits[i]++;
+      }
+    });
+
+  for (gt::size_type i = 0; i < n; i++) {
+    ASSERT_EQ(hits[i], 1);
+  }
+}
+
+TEST(device_backend, host_parallel_for_throw)
+{
+  auto f = [](gt::size_type, gt::size_type end) {
+    if (end == 100000) {
+      throw std::runtime_error("last chunk failed");
+    }
+  };
+  EXPECT_THROW(gt::backend::host::parallel_for(100000, 10, f),
+               std::runtime_error);
+}
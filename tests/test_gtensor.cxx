@@ -292,6 +292,16 @@ TEST(gtensor, assign_expression_2d_resize)
   EXPECT_EQ(b, (gt::gtensor<double, 2>{{22., 24., 26.}, {42., 44., 46.}}));
 }
 
+TEST(gtensor, resize_same_size_keeps_storage)
+{
+  gt::gtensor<double, 2> a{{11., 12., 13.}, {21., 22., 23.}};
+  auto data = a.data();
+  a.resize({2, 3});
+  EXPECT_EQ(a.shape(), gt::shape(2, 3));
+  EXPECT_EQ(a.data(), data);
+  EXPECT_EQ(a(1, 2), 23.);
+}
+
 TEST(gtensor, type_aliases)
 {
   gt::gtensor<double, 1> h1(10);
@@ -145,6 +145,77 @@ TEST(gtensor_storage, host_resize_shrink)
   }
 }
 
+TEST(gtensor_storage, host_reserve_shrink_to_fit)
+{
+  constexpr int N = 16;
+  gt::backend::host_storage<double> h1(N);
+
+  for (int i = 0; i < h1.size(); i++) {
+    h1[i] = (double)i;
+  }
+
+  h1.reserve(4 * N);
+  EXPECT_EQ(h1.size(), N);
+  EXPECT_EQ(h1.capacity(), 4 * N);
+  auto data = h1.data();
+  h1.resize(3 * N);
+  EXPECT_EQ(h1.data(), data);
+
+  h1.resize(N / 2);
+  h1.shrink_to_fit();
+  EXPECT_EQ(h1.size(), N / 2);
+  EXPECT_EQ(h1.capacity(), N / 2);
+  for (int i = 0; i < N / 2; i++) {
+    EXPECT_EQ(h1[i], (double)i);
+  }
+
+  h1.resize(0);
+  h1.shrink_to_fit();
+  EXPECT_EQ(h1.capacity(), 0);
+  EXPECT_EQ(h1.data(), nullptr);
+}
+
+TEST(gtensor_storage, host_resize_policy)
+{
+  gt::backend::host_storage<double> h1(10);
+  h1.set_policy({2.0, 0.25});
+
+  h1.resize(11);
+  EXPECT_EQ(h1.capacity(), 20);
+  h1[10] = 10.;
+  h1.resize(20);
+  EXPECT_EQ(h1.capacity(), 20);
+  EXPECT_EQ(h1[10], 10.);
+  h1.resize(41);
+  EXPECT_EQ(h1.capacity(), 41);
+
+  h1.resize(11);
+  EXPECT_EQ(h1.capacity(), 41);
+  EXPECT_EQ(h1[10], 10.);
+  h1.resize(10);
+  EXPECT_EQ(h1.capacity(), 10);
+
+  auto h2 = h1;
+  EXPECT_EQ(h2.policy().growth_factor, 2.0);
+}
+
+TEST(gtensor_storage, move_assign_keeps_policy)
+{
+  auto shape = gt::shape(10);
+  gt::gtensor<double, 1> a(shape);
+  a.storage().set_policy({1.5, 0.25});
+
+  a = gt::zeros<double>(shape);
+  EXPECT_EQ(a.storage().policy().growth_factor, 1.5);
+  EXPECT_EQ(a.storage().policy().shrink_threshold, 0.25);
+
+  gt::backend::host_storage<double> h(10);
+  h.set_policy({2.0, 0.5});
+  h = gt::backend::host_storage<double>(20);
+  EXPECT_EQ(h.policy().growth_factor, 2.0);
+  EXPECT_EQ(h.policy().shrink_threshold, 0.5);
+}
+
 TEST(gtensor_storage, type_aliases)
 {
   gt::backend::host_storage<double> h1(10);
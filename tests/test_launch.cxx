@@ -72,6 +72,55 @@ TEST(gtensor, launch_view_reverse_1d)
   EXPECT_EQ(b, (gt::gtensor<double, 1>{13., 12., 11.}));
 }
 
+TEST(gtensor, launch_host_2d_large)
+{
+  gt::gtensor<int, 2> a(gt::shape(300, 200));
+  gt::gtensor<int, 2> b(a.shape(), 0);
+
+  auto k_a = a.to_kernel();
+  gt::launch_host<2>(
+    a.shape(), GT_LAMBDA(int i, int j) { k_a(i, j) = i + 1000 * j; });
+
+  for (int j = 0; j < a.shape(1); j++) {
+    for (int i = 0; i < a.shape(0); i++) {
+      b(i, j) = i + 1000 * j;
+    }
+  }
+  EXPECT_EQ(a, b);
+}
+
+void host_launch_policy_3d(gt::launch_policy policy)
+{
+  gt::gtensor<int, 3> a(gt::shape(7, 1000, 1), 0);
+  auto k_a = a.to_kernel();
+
+  gt::launch<3, gt::space::host>(
+    a.shape(), GT_LAMBDA(int i, int j, int k) { k_a(i, j, k) += 1; }, policy);
+
+  EXPECT_EQ(a, gt::full<int>(a.shape(), 1));
+}
+
+TEST(gtensor, launch_host_policy)
+{
+  gt::launch_policy policy;
+  host_launch_policy_3d(policy);
+
+  policy.grain_size = 10;
+  host_launch_policy_3d(policy);
+
+  policy.schedule = gt::launch_schedule::dynamic;
+  host_launch_policy_3d(policy);
+
+  policy.schedule = gt::launch_schedule::guided;
+  host_launch_policy_3d(policy);
+
+  policy.num_threads = 2;
+  host_launch_policy_3d(policy);
+
+  policy.grain_size = 100000;
+  host_launch_policy_3d(policy);
+}
+
 #ifdef GTENSOR_HAVE_DEVICE
 
 void device_double_add_1d(gt::gtensor_device<double, 1>& a,
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "gtensor/gtensor.h"
+#include "gtensor/memory_pool.h"
+
+#include "test_debug.h"
+
+TEST(memory_pool, arena)
+{
+  gt::memory_pool::arena a(std::malloc, std::free, 4096);
+
+  char* p1 = static_cast<char*>(a.allocate(1000));
+  char* p2 = static_cast<char*>(a.allocate(1));
+  char* p3 = static_cast<char*>(a.allocate(512));
+  EXPECT_EQ(a.size(), 4096);
+  EXPECT_EQ(a.used(), 1024 + 256 + 512);
+  EXPECT_EQ(p2, p1 + 1024);
+  EXPECT_EQ(p3, p2 + 256);
+
+  // best fit: the 256 byte hole is used for a small request
+  a.deallocate(p2);
+  char* p4 = static_cast<char*>(a.allocate(200));
+  EXPECT_EQ(p4, p2);
+
+  // freed neighbors are merged
+  a.deallocate(p1);
+  a.deallocate(p4);
+  char* p5 = static_cast<char*>(a.allocate(1280));
+  EXPECT_EQ(p5, p1);
+
+  // growing adds a chunk at least as large as what is held already
+  void* p6 = a.allocate(8192);
+  EXPECT_EQ(a.size(), 4096 + 8192);
+
+  a.deallocate(p6);
+  a.release();
+  EXPECT_EQ(a.size(), 4096);
+
+  a.deallocate(p3);
+  a.deallocate(p5);
+  EXPECT_EQ(a.used(), 0);
+  a.release();
+  EXPECT_EQ(a.size(), 0);
+}
+
+TEST(memory_pool, arena_max_size)
+{
+  gt::memory_pool::arena a(std::malloc, std::free, 4096, 8192);
+
+  void* p1 = a.allocate(4096);
+  void* p2 = a.allocate(4096);
+  EXPECT_NE(p1, nullptr);
+  EXPECT_NE(p2, nullptr);
+  EXPECT_EQ(a.allocate(256), nullptr);
+
+  // entirely free chunks are released to make room
+  a.deallocate(p1);
+  void* p3 = a.allocate(2048);
+  EXPECT_NE(p3, nullptr);
+  a.deallocate(p2);
+  a.deallocate(p3);
+  EXPECT_EQ(a.allocate(8192 + 1), nullptr);
+}
+
+#ifdef GTENSOR_USE_MEMORY_POOL
+
+TEST(memory_pool, host)
+{
+  auto& pool = gt::memory_pool::get_instance()
+                 .get_arena<gt::memory_pool::memory_type::host>();
+  auto used = pool.used();
+  {
+    gt::gtensor<double, 1, gt::space::host> h(gt::shape(1000), 1.);
+    EXPECT_EQ(pool.used(), used + 8192);
+    EXPECT_EQ(h(999), 1.);
+  }
+  EXPECT_EQ(pool.used(), used);
+}
+
+#endif
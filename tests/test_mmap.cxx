@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtensor/gtensor.h>
+#include <gtensor/mmap_storage.h>
+
+#include "test_debug.h"
+
+namespace
+{
+
+// temporary file that is removed when going out of scope
+struct temp_file
+{
+  temp_file()
+  {
+    char name[] = "/tmp/gtensor_test_mmap_XXXXXX";
+    int fd = mkstemp(name);
+    EXPECT_GE(fd, 0);
+    close(fd);
+    path = name;
+  }
+
+  ~temp_file() { std::remove(path.c_str()); }
+
+  template <typename T>
+  void write(const std::vector<T>& v, std::size_t offset = 0)
+  {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    std::vector<char> pad(offset, 'x');
+    f.write(pad.data(), pad.size());
+    f.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+  }
+
+  template <typename T>
+  std::vector<T> read(std::size_t offset = 0)
+  {
+    std::ifstream f(path, std::ios::binary);
+    f.seekg(0, std::ios::end);
+    std::size_t nbytes = std::size_t(f.tellg()) - offset;
+    std::vector<T> v(nbytes / sizeof(T));
+    f.seekg(offset);
+    f.read(reinterpret_cast<char*>(v.data()), v.size() * sizeof(T));
+    return v;
+  }
+
+  std::string path;
+};
+
+} // namespace
+
+TEST(mmap, read_only)
+{
+  temp_file file;
+  file.write(std::vector<double>{11., 21., 12., 22., 13., 23.});
+
+  auto a = gt::map_file<double, 2>(file.path, gt::shape(2, 3));
+  EXPECT_EQ(a.shape(), gt::shape(2, 3));
+  EXPECT_TRUE(a.storage().is_file_mapping());
+  EXPECT_EQ(a, (gt::gtensor<double, 2>{{11., 21.}, {12., 22.}, {13., 23.}}));
+
+  // usable in expressions and through spans like any host container
+  gt::gtensor<double, 2> b = 2. * a;
+  EXPECT_EQ(b(1, 2), 46.);
+  auto s = gt::adapt<2>(a.data(), a.shape());
+  EXPECT_EQ(s(0, 1), 12.);
+}
+
+TEST(mmap, copy_on_write)
+{
+  temp_file file;
+  file.write(std::vector<int>{1, 2, 3, 4});
+
+  auto a = gt::map_file<int, 1>(file.path, gt::shape(4),
+                                gt::map_mode::copy_on_write);
+  a(1) = 20;
+  a.view(gt::placeholders::_s(2, 4)) = 0;
+  EXPECT_EQ(a, (gt::gtensor<int, 1>{1, 20, 0, 0}));
+
+  // the file itself is unchanged
+  EXPECT_EQ(file.read<int>(), (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(mmap, shared_write)
+{
+  temp_file file;
+  file.write(std::vector<int>{1, 2, 3, 4});
+
+  {
+    auto a = gt::map_file<int, 1>(file.path, gt::shape(4),
+                                  gt::map_mode::shared_write);
+    a = a + 10;
+    a.storage().flush();
+  }
+  EXPECT_EQ(file.read<int>(), (std::vector<int>{11, 12, 13, 14}));
+
+  // the file is extended to hold the mapped elements
+  {
+    auto a = gt::map_file<int, 1>(file.path, gt::shape(6),
+                                  gt::map_mode::shared_write);
+    EXPECT_EQ(a(5), 0);
+    a(5) = 16;
+  }
+  EXPECT_EQ(file.read<int>(), (std::vector<int>{11, 12, 13, 14, 0, 16}));
+}
+
+TEST(mmap, offset)
+{
+  temp_file file;
+  // an offset that is not a multiple of the page size
+  std::size_t offset = 40;
+  file.write(std::vector<float>{1.f, 2.f, 3.f}, offset);
+
+  auto a = gt::map_file<float, 1>(file.path, gt::shape(3),
+                                  gt::map_mode::read_only, offset);
+  EXPECT_EQ(a, (gt::gtensor<float, 1>{1.f, 2.f, 3.f}));
+}
+
+TEST(mmap, errors)
+{
+  temp_file file;
+  file.write(std::vector<double>{1., 2.});
+
+  EXPECT_THROW((gt::map_file<double, 1>(file.path, gt::shape(3))),
+               std::runtime_error);
+  EXPECT_THROW(
+    (gt::map_file<double, 1>(file.path + ".missing", gt::shape(1))),
+    std::runtime_error);
+  // the elements would not be aligned
+  EXPECT_THROW((gt::map_file<double, 1>(file.path, gt::shape(1),
+                                        gt::map_mode::read_only, 4)),
+               std::runtime_error);
+
+  // a file mapping cannot grow
+  auto a = gt::map_file<double, 1>(file.path, gt::shape(2));
+  EXPECT_THROW(a.resize(gt::shape(3)), std::runtime_error);
+}
+
+TEST(mmap, copy)
+{
+  temp_file file;
+  file.write(std::vector<double>{1., 2., 3.});
+
+  auto a = gt::map_file<double, 1>(file.path, gt::shape(3));
+  // copies are anonymous mappings holding the data
+  auto b = a;
+  EXPECT_FALSE(b.storage().is_file_mapping());
+  b(0) = 10.;
+  EXPECT_EQ(b, (gt::gtensor<double, 1>{10., 2., 3.}));
+  EXPECT_EQ(a, (gt::gtensor<double, 1>{1., 2., 3.}));
+
+  // anonymous mmap storage can be resized like other storage
+  gt::mmap_gtensor<double, 1> c(gt::shape(2));
+  c.resize(gt::shape(4));
+  c.fill(1.);
+  EXPECT_EQ(c, (gt::gtensor<double, 1>{1., 1., 1., 1.}));
+}
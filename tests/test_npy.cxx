@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <gtensor/gtensor.h>
+#include <gtensor/npy.h>
+
+#include "test_debug.h"
+
+using namespace gt::placeholders;
+
+namespace
+{
+
+// temporary file name that is removed when going out of scope
+struct temp_file
+{
+  temp_file()
+  {
+    char name[] = "/tmp/gtensor_test_npy_XXXXXX";
+    int fd = mkstemp(name);
+    EXPECT_GE(fd, 0);
+    close(fd);
+    path = name;
+  }
+
+  ~temp_file() { std::remove(path.c_str()); }
+
+  std::string contents() const
+  {
+    std::ifstream f(path, std::ios::binary);
+    std::stringstream s;
+    s << f.rdbuf();
+    return s.str();
+  }
+
+  std::string path;
+};
+
+} // namespace
+
+TEST(npy, save_load)
+{
+  temp_file file;
+  gt::gtensor<double, 3> a(gt::shape(2, 3, 4));
+  for (int i = 0; i < a.size(); i++) {
+    a.data()[i] = i;
+  }
+  gt::save_npy(file.path, a);
+
+  // column-major data is written as is, with a 64-byte aligned header
+  auto s = file.contents();
+  EXPECT_EQ(s.substr(0, 8), std::string("\x93NUMPY\x01\x00", 8));
+  EXPECT_NE(s.find("{'descr': '<f8', 'fortran_order': True, "
+                   "'shape': (2, 3, 4), }"),
+            std::string::npos);
+  EXPECT_EQ(s.size(), 128 + a.size() * sizeof(double));
+  EXPECT_EQ(s[127], '\n');
+
+  auto b = gt::load_npy<double, 3>(file.path);
+  EXPECT_EQ(b.shape(), a.shape());
+  EXPECT_EQ(b, a);
+}
+
+TEST(npy, complex)
+{
+  using T = gt::complex<float>;
+  temp_file file;
+  gt::gtensor<T, 1> a{T(1., 2.), T(3., -4.)};
+  gt::save_npy(file.path, a);
+  EXPECT_NE(file.contents().find("'descr': '<c8'"), std::string::npos);
+  EXPECT_NE(file.contents().find("'shape': (2,)"), std::string::npos);
+  EXPECT_EQ((gt::load_npy<T, 1>(file.path)), a);
+}
+
+TEST(npy, save_span_and_view)
+{
+  temp_file file;
+  gt::gtensor<int, 2> a{{1, 2, 3}, {4, 5, 6}};
+
+  gt::save_npy(file.path, a.to_kernel());
+  EXPECT_EQ((gt::load_npy<int, 2>(file.path)), a);
+
+  gt::save_npy(file.path, a.view(_s(1, 3), _all));
+  EXPECT_EQ((gt::load_npy<int, 2>(file.path)),
+            (gt::gtensor<int, 2>{{2, 3}, {5, 6}}));
+
+  gt::save_npy(file.path, a + 10);
+  EXPECT_EQ((gt::load_npy<int, 2>(file.path)),
+            (gt::gtensor<int, 2>{{11, 12, 13}, {14, 15, 16}}));
+}
+
+TEST(npy, load_c_order)
+{
+  temp_file file;
+  // np.array([[1, 2, 3], [4, 5, 6]], dtype=np.int32), in C order
+  std::string dict = "{'descr': '<i4', 'fortran_order': False, "
+                     "'shape': (2, 3), }";
+  dict.append(128 - 10 - dict.size() - 1, ' ');
+  dict += '\n';
+  std::string header("\x93NUMPY\x01\x00", 8);
+  header += char(dict.size());
+  header += char(0);
+  int data[] = {1, 2, 3, 4, 5, 6};
+  {
+    std::ofstream f(file.path, std::ios::binary);
+    f.write(header.data(), header.size());
+    f.write(dict.data(), dict.size());
+    f.write(reinterpret_cast<const char*>(data), sizeof(data));
+  }
+
+  auto a = gt::load_npy<int, 2>(file.path);
+  EXPECT_EQ(a.shape(), gt::shape(2, 3));
+  EXPECT_EQ(a(0, 0), 1);
+  EXPECT_EQ(a(0, 2), 3);
+  EXPECT_EQ(a(1, 0), 4);
+  EXPECT_EQ(a(1, 2), 6);
+
+  // C order data cannot be mapped as is
+  EXPECT_THROW((gt::load_npy_mmap<int, 2>(file.path)), std::runtime_error);
+}
+
+TEST(npy, load_mmap)
+{
+  temp_file file;
+  gt::gtensor<float, 2> a{{1.f, 2.f}, {3.f, 4.f}, {5.f, 6.f}};
+  gt::save_npy(file.path, a);
+
+  auto b = gt::load_npy_mmap<float, 2>(file.path);
+  EXPECT_TRUE(b.storage().is_file_mapping());
+  EXPECT_EQ(b, a);
+}
+
+TEST(npy, errors)
+{
+  temp_file file;
+  gt::gtensor<double, 2> a(gt::shape(2, 2), 1.);
+  gt::save_npy(file.path, a);
+
+  EXPECT_THROW((gt::load_npy<float, 2>(file.path)), std::runtime_error);
+  EXPECT_THROW((gt::load_npy<double, 3>(file.path)), std::runtime_error);
+  gt::gtensor<double, 2> b(gt::shape(2, 3));
+  EXPECT_THROW(gt::load_npy(file.path, b), std::runtime_error);
+  EXPECT_THROW((gt::load_npy<double, 2>(file.path + ".missing")),
+               std::runtime_error);
+}
+
+TEST(npz, save_load)
+{
+  temp_file file;
+  gt::gtensor<double, 2> rho{{1., 2.}, {3., 4.}};
+  gt::gtensor<int, 1> n{5, 6, 7};
+  gt::save_npz(file.path, "rho", rho, "n", n);
+
+  gt::npz_reader npz(file.path);
+  EXPECT_EQ(npz.names(), (std::vector<std::string>{"rho", "n"}));
+  EXPECT_EQ((npz.load<double, 2>("rho")), rho);
+  EXPECT_EQ((gt::load_npz<int, 1>(file.path, "n.npy")), n);
+
+  // members are stored uncompressed, so they can be mapped in place
+  auto m = npz.load_mmap<double, 2>("rho");
+  EXPECT_TRUE(m.storage().is_file_mapping());
+  EXPECT_EQ(m, rho);
+
+  gt::gtensor<int, 1> h(gt::shape(3));
+  npz.load("n", h);
+  EXPECT_EQ(h, n);
+
+  EXPECT_THROW((npz.load<double, 2>("phi")), std::runtime_error);
+}
+
+TEST(npz, load_mmap_aligned)
+{
+  temp_file file;
+  // odd sized members and names, which would leave the data that follows
+  // them unaligned without padding
+  gt::gtensor<char, 1> c{'a', 'b', 'c'};
+  gt::gtensor<double, 1> x{1., 2., 3.};
+  gt::gtensor<std::complex<double>, 1> z{{1., 2.}, {3., 4.}};
+  gt::save_npz(file.path, "c", c, "x_1", x, "zz", z);
+
+  gt::npz_reader npz(file.path);
+  auto mx = npz.load_mmap<double, 1>("x_1");
+  auto mz = npz.load_mmap<std::complex<double>, 1>("zz");
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mx.data()) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mz.data()) % 64, 0);
+  EXPECT_EQ(mx, x);
+  EXPECT_EQ(mz, z);
+  EXPECT_EQ((npz.load<char, 1>("c")), c);
+}
+
+TEST(npy, load_mmap_unaligned)
+{
+  temp_file file;
+  // a header that leaves the data at an offset of 75 bytes
+  std::string dict = "{'descr': '<f8', 'fortran_order': True, "
+                     "'shape': (2,), }";
+  dict.append(75 - 10 - dict.size() - 1, ' ');
+  dict += '\n';
+  std::string header("\x93NUMPY\x01\x00", 8);
+  header += char(dict.size());
+  header += char(0);
+  double data[] = {1., 2.};
+  {
+    std::ofstream f(file.path, std::ios::binary);
+    f.write(header.data(), header.size());
+    f.write(dict.data(), dict.size());
+    f.write(reinterpret_cast<const char*>(data), sizeof(data));
+  }
+
+  EXPECT_THROW((gt::load_npy_mmap<double, 1>(file.path)), std::runtime_error);
+  EXPECT_EQ((gt::load_npy<double, 1>(file.path)),
+            (gt::gtensor<double, 1>{1., 2.}));
+}
+
+template <typename S>
+void test_save_load_space()
+{
+  temp_file file;
+  gt::gtensor<double, 2, S> a{{1., 2.}, {3., 4.}, {5., 6.}};
+  gt::save_npy(file.path, a);
+
+  gt::gtensor<double, 2, S> b(a.shape());
+  gt::load_npy(file.path, b);
+
+  gt::gtensor<double, 2> h(b.shape());
+  gt::copy(b, h);
+  EXPECT_EQ(h, (gt::gtensor<double, 2>{{1., 2.}, {3., 4.}, {5., 6.}}));
+
+  gt::npz_writer npz(file.path);
+  npz.add("a", a.view(_all, 1));
+  npz.close();
+  EXPECT_EQ((gt::load_npz<double, 1>(file.path, "a")),
+            (gt::gtensor<double, 1>{3., 4.}));
+}
+
+TEST(npy, host_save_load) { test_save_load_space<gt::space::host>(); }
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+TEST(npy, device_save_load) { test_save_load_space<gt::space::device>(); }
+
+#endif
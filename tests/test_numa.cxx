@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "gtensor/gtensor.h"
+#include "gtensor/numa.h"
+
+#include "test_debug.h"
+
+TEST(numa, node_list)
+{
+  EXPECT_EQ(gt::numa::detail::max_node_in_list("0\n"), 0);
+  EXPECT_EQ(gt::numa::detail::max_node_in_list("0-3"), 3);
+  EXPECT_EQ(gt::numa::detail::max_node_in_list("0-3,8,10-11"), 11);
+  EXPECT_EQ(gt::numa::detail::max_node_in_list(""), -1);
+  EXPECT_GE(gt::numa::num_nodes(), 1);
+}
+
+TEST(numa, first_touch_fill)
+{
+  if (!gt::numa::available()) {
+    GTEST_SKIP() << "NUMA system calls not available";
+  }
+  gt::gtensor<double, 2, gt::space::host> h(gt::shape(1024, 1024));
+  h.fill(0.);
+
+  auto counts = gt::numa::placement(h);
+  ASSERT_EQ(counts.size(), gt::numa::num_nodes());
+  gt::size_type npages = 0;
+  for (auto count : counts) {
+    npages += count;
+  }
+  EXPECT_GE(npages, h.size() * sizeof(double) / gt::numa::detail::page_size());
+}
+
+TEST(numa, set_policy)
+{
+  if (!gt::numa::available()) {
+    GTEST_SKIP() << "NUMA system calls not available";
+  }
+  gt::gtensor<double, 1, gt::space::host> a(gt::shape(1 << 20));
+  EXPECT_TRUE(gt::numa::interleave(a));
+  EXPECT_TRUE(gt::numa::bind(a, 0));
+  EXPECT_FALSE(gt::numa::bind(a, gt::numa::num_nodes()));
+  a.fill(1.);
+
+  // bound pages stay on node 0, even once touched
+  auto nodes = gt::numa::page_nodes(a.data(), a.size() * sizeof(double));
+  ASSERT_GT(nodes.size(), 2);
+  for (std::size_t i = 1; i < nodes.size() - 1; i++) {
+    EXPECT_EQ(nodes[i], 0);
+  }
+  EXPECT_TRUE(gt::numa::set_policy(a, gt::numa::policy::local));
+  EXPECT_EQ(a(a.shape(0) - 1), 1.);
+}
@@ -3,8 +3,11 @@
 #include <gtensor/gtensor.h>
 #include <gtensor/reductions.h>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <type_traits>
+#include <vector>
 
 #include "test_debug.h"
 
@@ -61,6 +64,98 @@ TEST(reductions, sum_axis_to_3d_view_2d)
   EXPECT_EQ(asum1.view(1, _all), (gt::gtensor<double, 1>{-23., -43., -63.}));
 }
 
+TEST(reductions, reduce_axis_to_multi_axis)
+{
+  gt::gtensor<double, 4> a(gt::shape(3, 4, 5, 6));
+  for (int l = 0; l < 6; l++) {
+    for (int k = 0; k < 5; k++) {
+      for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 3; i++) {
+          a(i, j, k, l) = i + 10 * j - 3 * k + 7 * l;
+        }
+      }
+    }
+  }
+
+  gt::gtensor<double, 2> asum(gt::shape(3, 5));
+  gt::gtensor<double, 2> amax(gt::shape(3, 5));
+  gt::gtensor<double, 2> amin(gt::shape(3, 5));
+  gt::sum_axis_to(asum, a, gt::shape(3, 1));
+  gt::max_axis_to(amax, a, gt::shape(1, 3));
+  gt::min_axis_to(amin, a, gt::shape(1, 3));
+
+  for (int k = 0; k < 5; k++) {
+    for (int i = 0; i < 3; i++) {
+      double sum = 0.;
+      for (int l = 0; l < 6; l++) {
+        for (int j = 0; j < 4; j++) {
+          sum += a(i, j, k, l);
+        }
+      }
+      EXPECT_EQ(asum(i, k), sum);
+      EXPECT_EQ(amax(i, k), a(i, 3, k, 5));
+      EXPECT_EQ(amin(i, k), a(i, 0, k, 0));
+    }
+  }
+
+  gt::gtensor<double, 1> aprod(gt::shape(4));
+  gt::prod_axis_to(aprod, a.view(gt::slice(1, 3), _all, 0, gt::slice(0, 2)),
+                   gt::shape(0, 2));
+  for (int j = 0; j < 4; j++) {
+    EXPECT_EQ(aprod(j), a(1, j, 0, 0) * a(2, j, 0, 0) * a(1, j, 0, 1) *
+                          a(2, j, 0, 1));
+  }
+
+  gt::gtensor<double, 3> amax1(gt::shape(3, 4, 6));
+  gt::reduce_axis_to(amax1, a, 2, [](double x, double y) {
+    return std::max(x, y);
+  });
+  EXPECT_EQ(amax1(2, 3, 5), a(2, 3, 0, 5));
+}
+
+TEST(reductions, sum_axis_to_long_axis)
+{
+  // small output and a long reduced axis, which is split into chunks when
+  // there is more than one worker
+  const int n = 100000;
+  gt::gtensor<double, 2> a(gt::shape(2, n));
+  for (int j = 0; j < n; j++) {
+    a(0, j) = j % 10;
+    a(1, j) = -(j % 7);
+  }
+
+  gt::gtensor<double, 1> asum(gt::shape(2));
+  gt::gtensor<double, 1> amin(gt::shape(2));
+  gt::sum_axis_to(asum, a, 1);
+  gt::min_axis_to(amin, a, 1);
+
+  double sum0 = 0., sum1 = 0.;
+  for (int j = 0; j < n; j++) {
+    sum0 += a(0, j);
+    sum1 += a(1, j);
+  }
+  EXPECT_EQ(asum, (gt::gtensor<double, 1>{sum0, sum1}));
+  EXPECT_EQ(amin, (gt::gtensor<double, 1>{0., -6.}));
+}
+
+TEST(reductions, min_axis_to_uneven_chunks)
+{
+  // the reduced extent is not a multiple of the number of chunks, so that
+  // rounding the chunk size up would leave trailing chunks empty
+  const int n = 20000000;
+  gt::gtensor<int, 2> a(gt::shape(1, n));
+  for (int j = 0; j < n; j++) {
+    a(0, j) = 1 + j % 5;
+  }
+
+  gt::gtensor<int, 1> amin(gt::shape(1));
+  gt::gtensor<int, 1> asum(gt::shape(1));
+  gt::min_axis_to(amin, a, 1);
+  gt::sum_axis_to(asum, a, 1);
+  EXPECT_EQ(amin(0), 1);
+  EXPECT_EQ(asum(0), 3 * n);
+}
+
 #ifdef GTENSOR_HAVE_DEVICE
 
 TEST(reductions, device_sum_axis_to_2d)
@@ -131,6 +226,50 @@ TEST(reductions, device_sum_axis_to_3d_view_2d)
   EXPECT_EQ(h_asum1.view(1, _all), (gt::gtensor<double, 1>{-23., -43., -63.}));
 }
 
+TEST(reductions, device_sum_axis_to_long_axis)
+{
+  const int n = 100000;
+  gt::gtensor<double, 3> h_a(gt::shape(2, n, 3));
+  for (int k = 0; k < 3; k++) {
+    for (int j = 0; j < n; j++) {
+      h_a(0, j, k) = j % 10;
+      h_a(1, j, k) = -(j % 7);
+    }
+  }
+  gt::gtensor_device<double, 3> a(h_a.shape());
+  gt::copy(h_a, a);
+
+  gt::gtensor_device<double, 1> amax(gt::shape(2));
+  gt::gtensor<double, 1> h_amax(gt::shape(2));
+  gt::max_axis_to(amax, a, gt::shape(1, 2));
+  gt::copy(amax, h_amax);
+  EXPECT_EQ(h_amax, (gt::gtensor<double, 1>{9., 0.}));
+}
+
+TEST(reductions, device_min_axis_to_uneven_chunks)
+{
+  // n_red / AXIS_REDUCE_MIN_CHUNK chunks, rounded up to a chunk size that
+  // would leave the trailing ones empty
+  const int n = 20000000;
+  gt::gtensor<int, 2> h_a(gt::shape(1, n));
+  for (int j = 0; j < n; j++) {
+    h_a(0, j) = 1 + j % 5;
+  }
+  gt::gtensor_device<int, 2> a(h_a.shape());
+  gt::copy(h_a, a);
+
+  gt::gtensor_device<int, 1> amin(gt::shape(1));
+  gt::gtensor_device<int, 1> asum(gt::shape(1));
+  gt::min_axis_to(amin, a, 1);
+  gt::sum_axis_to(asum, a, 1);
+  gt::gtensor<int, 1> h_amin(gt::shape(1));
+  gt::gtensor<int, 1> h_asum(gt::shape(1));
+  gt::copy(amin, h_amin);
+  gt::copy(asum, h_asum);
+  EXPECT_EQ(h_amin(0), 1);
+  EXPECT_EQ(h_asum(0), 3 * n);
+}
+
 #endif // GTENSOR_HAVE_DEVICE
 
 template <typename S>
@@ -330,3 +469,355 @@ TEST(reductions, device_reduce_sum_sq_1d_stream_complex)
 }
 
 #endif // GTENSOR_HAVE_DEVICE
+
+TEST(reductions, host_large_1d)
+{
+  // large enough to be split across workers, with a ragged tail
+  const int n = 1000003;
+  gt::gtensor<double, 1> a(gt::shape(n));
+  for (int i = 0; i < n; i++) {
+    a(i) = i % 1000;
+  }
+  a(n / 3) = 5000.;
+  a(n - 1) = -7.;
+
+  double expected = 0.;
+  for (int i = 0; i < n; i++) {
+    expected += a(i);
+  }
+
+  EXPECT_EQ(gt::sum(a), expected);
+  EXPECT_EQ(gt::max(a), 5000.);
+  EXPECT_EQ(gt::min(a), -7.);
+  EXPECT_EQ(gt::reduce(a, 10., std::plus<double>{}), expected + 10.);
+  EXPECT_EQ(gt::transform_reduce(a, 0., std::plus<double>{},
+                                 [](double x) { return x > 500. ? 1. : 0.; }),
+            double(n / 1000 * 499 + 1));
+}
+
+TEST(reductions, host_sum_small)
+{
+  gt::gtensor<int, 1> a{3, 1, 4, 1, 5};
+  EXPECT_EQ(gt::sum(a), 14);
+  EXPECT_EQ(gt::max(a), 5);
+  EXPECT_EQ(gt::min(a), 1);
+
+  gt::gtensor<double, 1> empty(gt::shape(0));
+  EXPECT_EQ(gt::sum(empty), 0.);
+  EXPECT_EQ(gt::reduce(empty, 2., std::plus<double>{}), 2.);
+}
+
+TEST(reductions, host_deterministic_sum)
+{
+  const int n = 300001;
+  gt::gtensor<float, 1> a(gt::shape(n));
+  for (int i = 0; i < n; i++) {
+    a(i) = 1.f / (1 + i % 977);
+  }
+
+  bool was_deterministic = gt::get_deterministic_reductions();
+  gt::set_deterministic_reductions(true);
+
+  float parallel = gt::sum(a);
+  // reductions nested inside parallel host work run on a single worker
+  float serial = 0.f;
+  gt::backend::host::detail::run_workers(1,
+                                         [&](int tid) { serial = gt::sum(a); });
+
+  gt::set_deterministic_reductions(was_deterministic);
+
+  EXPECT_EQ(parallel, serial);
+  EXPECT_NEAR(parallel, gt::sum(a), 1e-3f * parallel);
+}
+
+TEST(reductions, host_expression)
+{
+  const int n0 = 37, n1 = 1000;
+  gt::gtensor<double, 2> a(gt::shape(n0, n1));
+  gt::gtensor<double, 2> b(gt::shape(n0, n1));
+  for (int j = 0; j < n1; j++) {
+    for (int i = 0; i < n0; i++) {
+      a(i, j) = i + j;
+      b(i, j) = i - j;
+    }
+  }
+
+  auto expr = a + 2. * b;
+  gt::gtensor<double, 2> expr_eval = expr;
+  EXPECT_EQ(gt::sum(expr), gt::sum(expr_eval));
+  EXPECT_EQ(gt::max(expr), 3. * (n0 - 1));
+  EXPECT_EQ(gt::min(expr), -(n1 - 1.));
+  EXPECT_EQ(gt::reduce(expr, 1., std::plus<double>{}),
+            gt::sum(expr_eval) + 1.);
+
+  // non-contiguous views, broadcasting and expressions without strided access
+  auto av = a.view(gt::slice(1, n0, 2), gt::slice(n1 - 1, gt::none, -3));
+  gt::gtensor<double, 2> av_eval = av;
+  EXPECT_EQ(gt::sum(av), gt::sum(av_eval));
+  EXPECT_EQ(gt::max(gt::transpose(a, gt::shape(1, 0))), n0 + n1 - 2.);
+
+  gt::gtensor<double, 1> col = a.view(gt::all, 0);
+  gt::gtensor<double, 2> bcast_eval = a + col.view(gt::all, gt::newaxis);
+  EXPECT_EQ(gt::sum(a + col.view(gt::all, gt::newaxis)), gt::sum(bcast_eval));
+
+  EXPECT_EQ(gt::sum(gt::arange<double>(0, 1000)), 999. * 1000. / 2.);
+  EXPECT_EQ(gt::sum_squares(a - b), gt::sum_squares(gt::eval(a - b)));
+}
+
+TEST(reductions, reduce_many)
+{
+  const int n = 100003;
+  gt::gtensor<double, 1> a(gt::shape(n));
+  for (int i = 0; i < n; i++) {
+    a(i) = (i % 11) - 7.;
+  }
+
+  double sum, max_abs, sum_sq, max, min;
+  std::tie(sum, max_abs, sum_sq, max, min) = gt::reduce_many(
+    a, gt::reducers::sum{}, gt::reducers::max_abs{},
+    gt::reducers::sum_squares{}, gt::reducers::max{}, gt::reducers::min{});
+  EXPECT_EQ(sum, gt::sum(a));
+  EXPECT_EQ(max_abs, 7.);
+  EXPECT_EQ(sum_sq, gt::sum_squares(a));
+  EXPECT_EQ(max, 3.);
+  EXPECT_EQ(min, -7.);
+
+  // expressions, complex values and custom reducers
+  gt::gtensor<gt::complex<double>, 1> c{{3., 4.}, {0., -1.}, {1., 1.}};
+  auto count_nonzero = gt::make_reducer(
+    0, std::plus<int>{}, [](gt::complex<double> x) { return x != 0. ? 1 : 0; });
+  auto r = gt::reduce_many(2. * c, gt::reducers::max_abs{},
+                           gt::reducers::sum_squares{}, count_nonzero);
+  EXPECT_EQ(std::get<0>(r), 10.);
+  EXPECT_EQ(std::get<1>(r), 4. * (25. + 1. + 2.));
+  EXPECT_EQ(std::get<2>(r), 3);
+
+  gt::gtensor<double, 1> empty(gt::shape(0));
+  EXPECT_EQ(std::get<0>(gt::reduce_many(empty, gt::reducers::sum{})), 0.);
+}
+
+template <typename S>
+void test_scan(int n)
+{
+  gt::gtensor<int, 1> h_a(gt::shape(n));
+  gt::gtensor<int, 1> h_keys(gt::shape(n));
+  for (int i = 0; i < n; i++) {
+    h_a(i) = i % 7 - 2;
+    h_keys(i) = i / 1000;
+  }
+  gt::gtensor<int, 1, S> a(gt::shape(n));
+  gt::gtensor<int, 1, S> keys(gt::shape(n));
+  gt::copy(h_a, a);
+  gt::copy(h_keys, keys);
+
+  gt::gtensor<int, 1, S> incl(gt::shape(n));
+  gt::gtensor<int, 1, S> excl(gt::shape(n));
+  gt::gtensor<int, 1, S> incl_key(gt::shape(n));
+  gt::gtensor<int, 1, S> excl_key(gt::shape(n));
+  gt::inclusive_scan(a, incl);
+  gt::exclusive_scan(a, excl, 10);
+  gt::inclusive_scan_by_key(keys, a, incl_key);
+  gt::exclusive_scan_by_key(keys, a, excl_key, 5, gt::ops::plus{});
+
+  gt::gtensor<int, 1> h_incl(gt::shape(n));
+  gt::gtensor<int, 1> h_excl(gt::shape(n));
+  gt::gtensor<int, 1> h_incl_key(gt::shape(n));
+  gt::gtensor<int, 1> h_excl_key(gt::shape(n));
+  gt::copy(incl, h_incl);
+  gt::copy(excl, h_excl);
+  gt::copy(incl_key, h_incl_key);
+  gt::copy(excl_key, h_excl_key);
+
+  int acc = 0, acc_key = 0;
+  for (int i = 0; i < n; i++) {
+    if (i % 1000 == 0) {
+      acc_key = 0;
+    }
+    EXPECT_EQ(h_excl(i), 10 + acc);
+    EXPECT_EQ(h_excl_key(i), 5 + acc_key);
+    acc += h_a(i);
+    acc_key += h_a(i);
+    EXPECT_EQ(h_incl(i), acc);
+    EXPECT_EQ(h_incl_key(i), acc_key);
+  }
+}
+
+TEST(reductions, scan) { test_scan<gt::space::host>(100003); }
+
+TEST(reductions, scan_small) { test_scan<gt::space::host>(17); }
+
+TEST(reductions, scan_expression)
+{
+  const int n0 = 3, n1 = 20000;
+  gt::gtensor<double, 2> a(gt::shape(n0, n1));
+  for (int j = 0; j < n1; j++) {
+    for (int i = 0; i < n0; i++) {
+      a(i, j) = i + j % 5;
+    }
+  }
+
+  gt::gtensor<double, 2> expr_eval = 2. * a;
+  gt::gtensor<double, 2> scan_expr(a.shape());
+  gt::gtensor<double, 2> scan_eval(a.shape());
+  gt::inclusive_scan(2. * a, scan_expr);
+  gt::inclusive_scan(expr_eval, scan_eval);
+  EXPECT_EQ(scan_expr, scan_eval);
+  EXPECT_EQ(scan_eval(n0 - 1, n1 - 1), gt::sum(expr_eval));
+
+  // in place, with the result independent of the number of threads
+  gt::gtensor<double, 2> serial(a.shape());
+  gt::backend::host::detail::run_workers(
+    1, [&](int tid) { gt::inclusive_scan(expr_eval, serial); });
+  gt::inclusive_scan(expr_eval, expr_eval);
+  EXPECT_EQ(expr_eval, scan_eval);
+  EXPECT_EQ(serial, scan_eval);
+
+  gt::gtensor<int, 1> max_scan(gt::shape(5));
+  gt::inclusive_scan(gt::gtensor<int, 1>{3, 1, 4, 1, 5}, max_scan,
+                     [](int x, int y) { return std::max(x, y); });
+  EXPECT_EQ(max_scan, (gt::gtensor<int, 1>{3, 3, 4, 4, 5}));
+
+  gt::gtensor<double, 1> empty(gt::shape(0));
+  gt::exclusive_scan(empty, empty, 0.);
+}
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+TEST(reductions, device_scan) { test_scan<gt::space::device>(100003); }
+
+TEST(reductions, device_scan_small) { test_scan<gt::space::device>(17); }
+
+#endif // GTENSOR_HAVE_DEVICE
+
+template <typename S>
+void test_summation_policies()
+{
+  const int n0 = 3, n1 = 1 << 20;
+  gt::gtensor<float, 2> h_a(gt::shape(n0, n1));
+  double exact = 0.;
+  std::vector<double> exact_rows(n0, 0.);
+  for (int j = 0; j < n1; j++) {
+    for (int i = 0; i < n0; i++) {
+      h_a(i, j) = 1.f + (j % 1001) * 1e-3f;
+      exact += h_a(i, j);
+      exact_rows[i] += h_a(i, j);
+    }
+  }
+  gt::gtensor<float, 2, S> a(h_a.shape());
+  gt::copy(h_a, a);
+
+  const double tol = 1e-6 * exact;
+  EXPECT_NEAR(gt::sum(a, gt::summation::pairwise{}), exact, tol);
+  EXPECT_NEAR(gt::sum(a, gt::summation::kahan{}), exact, tol);
+  EXPECT_NEAR(gt::sum(a, gt::summation::widened{}), exact, tol);
+  EXPECT_NEAR(gt::sum(2.f * a, gt::summation::kahan{}), 2. * exact, 2. * tol);
+  EXPECT_NEAR(gt::reduce(a, 1.f, std::plus<float>{}, gt::summation::kahan{}),
+              exact + 1., tol);
+  EXPECT_NEAR(gt::sum_squares(a, gt::summation::kahan{}),
+              gt::sum_squares(gt::gtensor<double, 2>(h_a)), tol * 10.);
+
+  gt::gtensor<float, 1, S> rows(gt::shape(n0));
+  gt::gtensor<float, 1> h_rows(gt::shape(n0));
+  for (auto policy : {0, 1, 2}) {
+    if (policy == 0) {
+      gt::sum_axis_to(rows, a, 1, gt::summation::pairwise{});
+    } else if (policy == 1) {
+      gt::sum_axis_to(rows, a, 1, gt::summation::kahan{});
+    } else {
+      gt::sum_axis_to(rows, a, gt::sarray<int, 1>{1},
+                      gt::summation::widened{});
+    }
+    gt::copy(rows, h_rows);
+    for (int i = 0; i < n0; i++) {
+      EXPECT_NEAR(h_rows(i), exact_rows[i], 1e-6 * exact_rows[i]);
+    }
+  }
+}
+
+TEST(reductions, summation_policies)
+{
+  test_summation_policies<gt::space::host>();
+
+  // a long plain float sum loses digits that the policies keep
+  const int n = 1 << 24;
+  gt::gtensor<float, 1> a(gt::shape(n));
+  a.fill(0.1f);
+  gt::gtensor<float, 1> sum(gt::shape(1));
+  double exact = n * double(0.1f);
+  gt::sum_axis_to(sum, a.view(gt::all, gt::newaxis), 0);
+  EXPECT_GT(std::abs(sum(0) - exact), 1e-4 * exact);
+  gt::sum_axis_to(sum, a.view(gt::all, gt::newaxis), 0,
+                  gt::summation::pairwise{});
+  EXPECT_NEAR(sum(0), exact, 1e-6 * exact);
+}
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+TEST(reductions, device_summation_policies)
+{
+  test_summation_policies<gt::space::device>();
+}
+
+#endif // GTENSOR_HAVE_DEVICE
+
+template <typename S>
+void test_argmax()
+{
+  const int n0 = 5, n1 = 4000;
+  gt::gtensor<double, 2> h_a(gt::shape(n0, n1));
+  for (int j = 0; j < n1; j++) {
+    for (int i = 0; i < n0; i++) {
+      h_a(i, j) = ((i * 7 + j * 13) % 101) - 50.;
+    }
+  }
+  h_a(3, 1234) = 100.;
+  h_a(2, 777) = -100.;
+  h_a(4, 3000) = 100.;
+  gt::gtensor<double, 2, S> a(h_a.shape());
+  gt::copy(h_a, a);
+
+  auto amax = gt::argmax(a);
+  EXPECT_EQ(amax.value, 100.);
+  EXPECT_EQ(amax.index, 3 + 1234 * n0);
+  EXPECT_EQ(amax.multi_index, gt::shape(3, 1234));
+
+  auto amin = gt::argmin(2. * a + 1.);
+  EXPECT_EQ(amin.value, -199.);
+  EXPECT_EQ(amin.multi_index, gt::shape(2, 777));
+
+  auto aview = gt::argmax(a.view(gt::slice(1, 4), gt::slice(2000, gt::none)));
+  EXPECT_EQ(aview.value, 50.);
+
+  gt::gtensor<int, 1, S> cols(gt::shape(n1));
+  gt::argmax_axis_to(cols, a, 0);
+  gt::gtensor<int, 1> h_cols(cols.shape());
+  gt::copy(cols, h_cols);
+  EXPECT_EQ(h_cols(1234), 3);
+  EXPECT_EQ(h_cols(3000), 4);
+
+  gt::gtensor<int, 1, S> rows(gt::shape(n0));
+  gt::argmin_axis_to(rows, a, 1);
+  gt::gtensor<int, 1> h_rows(rows.shape());
+  gt::copy(rows, h_rows);
+  EXPECT_EQ(h_rows(2), 777);
+  for (int i = 0; i < n0; i++) {
+    EXPECT_EQ(h_a(i, h_rows(i)), i == 2 ? -100. : -50.);
+  }
+
+  auto top = gt::top_k(a, 3);
+  ASSERT_EQ(top.size(), 3);
+  EXPECT_EQ(top[0].index, 3 + 1234 * n0);
+  EXPECT_EQ(top[1].multi_index, gt::shape(4, 3000));
+  EXPECT_EQ(top[2].value, 50.);
+  EXPECT_EQ(gt::top_k(a.view(gt::all, gt::slice(0, 1)), 10).size(), n0);
+  EXPECT_TRUE(gt::top_k(a, 0).empty());
+  EXPECT_TRUE(gt::top_k(a.view(gt::all, gt::slice(0, 1)), 0).empty());
+}
+
+TEST(reductions, argmax) { test_argmax<gt::space::host>(); }
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+TEST(reductions, device_argmax) { test_argmax<gt::space::device>(); }
+
+#endif // GTENSOR_HAVE_DEVICE
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "gtensor/gtensor.h"
+
+#include "test_debug.h"
+
+// what gt::space::host allocations are counted as, host_pinned in device builds
+constexpr auto host_allocation_space =
+  gt::detail::space_allocation_kind<gt::space::host>::value;
+
+TEST(scratch, scope_reuse)
+{
+  gt::gtensor<double, 1> a(gt::shape(1000), 1.);
+  const double* tmp_data = nullptr;
+  gt::size_type num_allocations = 0;
+  for (int i = 0; i < 5; i++) {
+    gt::scratch_scope scratch;
+    EXPECT_TRUE(gt::scratch_active());
+    auto tmp = gt::eval(a + double(i));
+    EXPECT_EQ(tmp(999), 1. + i);
+    if (i == 0) {
+      tmp_data = tmp.data();
+      num_allocations =
+        gt::get_allocation_stats(host_allocation_space).num_allocations;
+    } else {
+      EXPECT_EQ(tmp.data(), tmp_data);
+      EXPECT_EQ(
+        gt::get_allocation_stats(host_allocation_space).num_allocations,
+        num_allocations);
+    }
+  }
+  EXPECT_FALSE(gt::scratch_active());
+
+  gt::release_scratch();
+}
+
+TEST(scratch, scope_nested)
+{
+  gt::scratch_scope outer;
+  auto x = gt::empty<float>({100});
+  x(99) = 3.f;
+  const float* y_data;
+  {
+    gt::scratch_scope inner;
+    auto y = gt::empty<float>({100});
+    y_data = y.data();
+    EXPECT_TRUE(gt::is_aligned(y_data, gt::detail::SCRATCH_ALIGNMENT));
+  }
+  auto z = gt::empty<float>({50});
+  EXPECT_EQ(z.data(), y_data);
+  EXPECT_EQ(x(99), 3.f);
+
+  // freeing the most recent allocation makes its space available again
+  const float* w_data;
+  {
+    auto w = gt::empty<float>({1000});
+    w_data = w.data();
+  }
+  auto v = gt::empty<float>({1000});
+  EXPECT_EQ(v.data(), w_data);
+}
+
+TEST(scratch, scope_outer_container)
+{
+  gt::gtensor<double, 1> a(gt::shape(1000), 1.);
+  gt::gtensor<double, 1> out;
+  gt::gtensor<double, 1> moved;
+  std::vector<gt::gtensor<double, 1>> list;
+  {
+    gt::scratch_scope scratch;
+    // containers that outlive the scope never get scratch memory
+    out = a + a;
+    moved = gt::eval(a + 2.);
+    list.push_back(a);
+    list.push_back(gt::gtensor<double, 1>(gt::shape(1000), 3.));
+    // scratch results moved into outer containers are copied out
+    list.push_back(gt::eval(a + 3.));
+    list.emplace_back(gt::empty<double>(gt::shape(1000)));
+    list.back().fill(5.);
+  }
+  {
+    gt::scratch_scope scratch;
+    auto t = gt::empty<double>(gt::shape(4000));
+    t.fill(-7.);
+  }
+  EXPECT_EQ(out(0), 2.);
+  EXPECT_EQ(out(999), 2.);
+  EXPECT_EQ(moved(999), 3.);
+  EXPECT_EQ(list[0](999), 1.);
+  EXPECT_EQ(list[1](999), 3.);
+  EXPECT_EQ(list[2](0), 4.);
+  EXPECT_EQ(list[2](999), 4.);
+  EXPECT_EQ(list[3](0), 5.);
+  EXPECT_EQ(list[3](999), 5.);
+
+  gt::release_scratch();
+}
+
+TEST(scratch, scope_consolidate)
+{
+  // more than fits in one chunk
+  const int n = GTENSOR_SCRATCH_CHUNK_SIZE / sizeof(double) / 2;
+  for (int i = 0; i < 2; i++) {
+    gt::scratch_scope scratch;
+    auto a = gt::empty<double>({n});
+    auto b = gt::empty<double>({n});
+    auto c = gt::empty<double>({n});
+    if (i == 1) {
+      // all in the one chunk that replaced the first iteration's
+      EXPECT_EQ(b.data(), a.data() + n);
+      EXPECT_EQ(c.data(), b.data() + n);
+    }
+  }
+  gt::release_scratch();
+
+  // outside of scopes storage is allocated as usual
+  auto stats = gt::get_allocation_stats(host_allocation_space);
+  {
+    auto d = gt::empty<double>({n});
+  }
+  EXPECT_EQ(
+    gt::get_allocation_stats(host_allocation_space).num_deallocations,
+    stats.num_deallocations + 1);
+}
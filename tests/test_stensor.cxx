@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <gtensor/gtensor.h>
+
+#include "test_debug.h"
+
+using namespace gt::placeholders;
+
+TEST(stensor, construct)
+{
+  gt::stensor<double, 3> a;
+  EXPECT_EQ(a.shape(), gt::shape(3));
+  EXPECT_EQ(a.size(), 3);
+  EXPECT_EQ(a(2), 0.);
+
+  gt::stensor<double, 3, 2> b = {{11., 21., 31.}, {12., 22., 32.}};
+  EXPECT_EQ(b.shape(), gt::shape(3, 2));
+  EXPECT_EQ(b(2, 0), 31.);
+  EXPECT_EQ(b(0, 1), 12.);
+  EXPECT_EQ(b.data()[3], 12.);
+
+  gt::stensor<double, 3, 2> c = 2. * b;
+  EXPECT_EQ(c(2, 1), 64.);
+
+  // kernels get the elements themselves
+  static_assert(
+    std::is_same<decltype(c.to_kernel()), gt::stensor<double, 3, 2>>::value,
+    "type mismatch");
+}
+
+TEST(stensor, assign)
+{
+  gt::stensor<int, 4> a;
+  gt::gtensor<int, 1> h{1, 2, 3, 4};
+
+  a = h + 1;
+  EXPECT_EQ(a(3), 5);
+
+  a.fill(7);
+  EXPECT_EQ(a(0), 7);
+
+  a.view(_s(1, 3)) = h.view(_s(0, 2));
+  EXPECT_EQ(a(0), 7);
+  EXPECT_EQ(a(1), 1);
+  EXPECT_EQ(a(2), 2);
+  EXPECT_EQ(a(3), 7);
+}
+
+TEST(stensor, print)
+{
+  gt::stensor<int, 3> a = {1, 2, 3};
+  std::ostringstream os, expected;
+  os << a;
+  expected << gt::gtensor<int, 1>{1, 2, 3};
+  EXPECT_EQ(os.str(), expected.str());
+}
+
+TEST(stensor, eval)
+{
+  gt::stensor<double, 3, 2> a = {{1., 2., 3.}, {4., 5., 6.}};
+
+  auto b = gt::eval(a);
+  static_assert(std::is_same<decltype(b), gt::gtensor<double, 2>>::value,
+                "type mismatch");
+  EXPECT_EQ(b, a);
+
+  auto c = gt::eval(2. * a);
+  static_assert(std::is_same<decltype(c), gt::gtensor<double, 2>>::value,
+                "type mismatch");
+  EXPECT_EQ(c, (gt::gtensor<double, 2>{{2., 4., 6.}, {8., 10., 12.}}));
+
+  auto d = gt::empty_like(a);
+  static_assert(std::is_same<decltype(d), gt::gtensor<double, 2>>::value,
+                "type mismatch");
+  EXPECT_EQ(d.shape(), a.shape());
+}
+
+template <typename S>
+void test_expression()
+{
+  gt::stensor<double, 3> stencil = {-0.5, 0., 0.5};
+  gt::gtensor<double, 1, S> y{1., 2., 4., 8., 16.};
+  gt::gtensor<double, 1, S> dydx(gt::shape(3));
+
+  gt::gtensor<double, 1> h(gt::shape(3));
+
+  dydx = stencil(0) * y.view(_s(0, -2)) + stencil(2) * y.view(_s(2, _));
+  gt::copy(dydx, h);
+  EXPECT_EQ(h, (gt::gtensor<double, 1>{1.5, 3., 6.}));
+
+  gt::gtensor<double, 1, S> z{1., 2., 3.};
+  gt::gtensor<double, 1, S> w = stencil * z;
+  gt::copy(w, h);
+  EXPECT_EQ(h, (gt::gtensor<double, 1>{-0.5, 0., 1.5}));
+}
+
+template <typename S>
+void test_launch()
+{
+  gt::stensor<double, 3> stencil = {-0.5, 0., 0.5};
+  gt::gtensor<double, 1, S> y{1., 2., 4., 8., 16.};
+  gt::gtensor<double, 1, S> dydx(gt::shape(3));
+
+  auto k_stencil = stencil.to_kernel();
+  auto k_y = y.to_kernel();
+  auto k_dydx = dydx.to_kernel();
+  gt::launch<1, S>(
+    dydx.shape(), GT_LAMBDA(int i) {
+      double sum = 0.;
+      for (int s = 0; s < 3; s++) {
+        sum += k_stencil(s) * k_y(i + s);
+      }
+      k_dydx(i) = sum;
+    });
+
+  gt::gtensor<double, 1> h(gt::shape(3));
+  gt::copy(dydx, h);
+  EXPECT_EQ(h, (gt::gtensor<double, 1>{1.5, 3., 6.}));
+}
+
+TEST(stensor, host_expression) { test_expression<gt::space::host>(); }
+
+TEST(stensor, host_launch) { test_launch<gt::space::host>(); }
+
+#ifdef GTENSOR_HAVE_DEVICE
+
+TEST(stensor, device_expression) { test_expression<gt::space::device>(); }
+
+TEST(stensor, device_launch) { test_launch<gt::space::device>(); }
+
+#endif
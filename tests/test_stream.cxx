@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
 #include "gtensor/gtensor.h"
+#include "gtensor/reductions.h"
 
 #include "test_debug.h"
 
@@ -23,6 +29,232 @@ TEST(stream, assign_gtensor_6d)
   EXPECT_EQ(a, b);
 }
 
+TEST(stream, event)
+{
+  gt::gtensor_device<int, 1> a(gt::shape(1000), 1);
+  gt::gtensor_device<int, 1> b(a.shape());
+
+  gt::stream stream;
+  gt::assign(b, a + 1, stream.get_view());
+  auto event = stream.get_view().record_event();
+  event.synchronize();
+  EXPECT_TRUE(event.query());
+
+  gt::gtensor<int, 1> h_b(b.shape());
+  gt::copy(b, h_b);
+  EXPECT_EQ(h_b(999), 2);
+}
+
+#ifndef GTENSOR_HAVE_DEVICE
+
+TEST(stream, host_stream_fifo)
+{
+  gt::gtensor<double, 2> a(gt::shape(64, 64));
+  auto k_a = a.to_kernel();
+
+  gt::stream stream;
+  EXPECT_FALSE(stream.is_default());
+
+  gt::launch<2>(
+    a.shape(), GT_LAMBDA(int i, int j) { k_a(i, j) = i + 100 * j; },
+    stream.get_view());
+  gt::launch<2>(
+    a.shape(), GT_LAMBDA(int i, int j) { k_a(i, j) *= 2; }, stream.get_view());
+  gt::assign(a, a + 1., stream.get_view());
+  stream.synchronize();
+
+  for (int j = 0; j < 64; j++) {
+    for (int i = 0; i < 64; i++) {
+      EXPECT_EQ(a(i, j), 2. * (i + 100 * j) + 1.);
+    }
+  }
+}
+
+TEST(stream, host_streams_independent)
+{
+  const int n = 1024 * 1024;
+  gt::gtensor<double, 1> a(gt::shape(n));
+  gt::gtensor<double, 1> b(gt::shape(n));
+  gt::gtensor<double, 1> c(gt::shape(n));
+
+  gt::stream s1;
+  gt::stream s2;
+
+  gt::assign(a, gt::arange<double>(0, n), s1.get_view());
+  gt::assign(b, 2. * gt::arange<double>(0, n), s2.get_view());
+  gt::copy_n(a.data(), a.size(), c.data(), s1.get_view());
+
+  // a value returning reduction waits for its stream
+  EXPECT_EQ(gt::sum(b, s2.get_view()), double(n) * (n - 1));
+
+  s1.synchronize();
+  EXPECT_EQ(a(n - 1), n - 1);
+  EXPECT_EQ(c, a);
+}
+
+TEST(stream, host_stream_exception)
+{
+  gt::stream stream;
+  gt::gtensor<int, 1> a(gt::shape(10));
+  auto k_a = a.to_kernel();
+
+  gt::launch<1>(
+    a.shape(),
+    [=](int i) {
+      if (i == 5) {
+        throw std::runtime_error("launch failed");
+      }
+      k_a(i) = i;
+    },
+    stream.get_view());
+  EXPECT_THROW(stream.synchronize(), std::runtime_error);
+
+  // the error is only reported once
+  stream.synchronize();
+}
+
+TEST(stream, assign_stensor)
+{
+  gt::stream s;
+  gt::gtensor<int, 1> h(gt::shape(4), 0);
+  auto k_h = h.to_kernel();
+
+  // work queued before the assign is seen by it
+  gt::launch<1>(
+    h.shape(), [=](int i) { k_h(i) = i + 1; }, s.get_view());
+
+  gt::stensor<int, 4> st;
+  st.fill(0);
+  gt::assign(st, h, s.get_view());
+  s.synchronize();
+  EXPECT_EQ(st(0), 1);
+  EXPECT_EQ(st(3), 4);
+
+  auto v = st.view(gt::placeholders::_s(1, 3));
+  gt::assign(v, h.view(gt::placeholders::_s(0, 2)) * 10, s.get_view());
+  s.synchronize();
+  EXPECT_EQ(st(0), 1);
+  EXPECT_EQ(st(1), 10);
+  EXPECT_EQ(st(2), 20);
+  EXPECT_EQ(st(3), 4);
+}
+
+#if defined(GTENSOR_HOST_PARALLEL_THREADS) ||                                  \
+  defined(GTENSOR_HOST_PARALLEL_OPENMP)
+
+TEST(stream, host_streams_concurrent)
+{
+  std::atomic<bool> flag{false};
+  bool seen = false;
+
+  gt::stream s1;
+  gt::stream s2;
+
+  // s1 can only see the flag if s2 runs while s1 is still busy
+  s1.get_view().submit([&] {
+    auto timeout =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!flag && std::chrono::steady_clock::now() < timeout) {
+      std::this_thread::yield();
+    }
+    seen = flag;
+  });
+  s2.get_view().submit([&] { flag = true; });
+
+  gt::synchronize();
+  EXPECT_TRUE(seen);
+}
+
+TEST(stream, host_stream_event)
+{
+  std::atomic<bool> release{false};
+
+  gt::stream s1;
+  gt::stream s2;
+
+  s1.get_view().submit([&] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  auto e1 = s1.get_view().record_event();
+  auto e2 = s2.get_view().record_event();
+  // the default stream's event covers all streams
+  auto e_default = gt::stream_view{}.record_event();
+
+  EXPECT_FALSE(e1.query());
+  EXPECT_TRUE(e2.query());
+  EXPECT_FALSE(e_default.query());
+
+  release = true;
+  e_default.synchronize();
+  EXPECT_TRUE(e1.query());
+}
+
+TEST(stream, host_stream_task_records_event)
+{
+  bool done = false;
+
+  gt::stream s;
+  // records an event while the main thread is blocked in synchronize()
+  s.get_view().submit([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto event = gt::stream_view{}.record_event();
+    done = true;
+  });
+
+  gt::synchronize();
+  EXPECT_TRUE(done);
+}
+
+TEST(stream, host_stream_task_synchronizes)
+{
+  bool done = false;
+
+  gt::stream s;
+  // waiting on its own stream from a task does not wait for the task itself
+  s.get_view().submit([&] {
+    gt::synchronize();
+    s.synchronize();
+    s.get_view().record_event().synchronize();
+    gt::stream_view{}.record_event().synchronize();
+    done = true;
+  });
+
+  s.synchronize();
+  EXPECT_TRUE(done);
+}
+
+TEST(stream, host_stream_temporary_rhs)
+{
+  constexpr int n = 1024;
+  std::atomic<bool> release{false};
+
+  gt::stream s;
+  gt::gtensor<double, 1> c(gt::shape(n), 0.);
+
+  s.get_view().submit([&] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  {
+    gt::gtensor<double, 1> tmp(gt::shape(n), 1.);
+    gt::assign(c, tmp, s.get_view());
+  }
+  // would likely reuse tmp's memory if it had been freed already
+  gt::gtensor<double, 1> other(gt::shape(n), -1.);
+
+  release = true;
+  s.synchronize();
+  EXPECT_EQ(c, (gt::gtensor<double, 1>(gt::shape(n), 1.)));
+  EXPECT_EQ(other, (gt::gtensor<double, 1>(gt::shape(n), -1.)));
+}
+
+#endif
+
+#endif // GTENSOR_HAVE_DEVICE
+
 #ifdef GTENSOR_HAVE_DEVICE
 
 void device_double_add_2d_stream(gt::gtensor_device<double, 2>& a,